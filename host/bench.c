@@ -0,0 +1,248 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Throughput of the Light CTL Client on the host. Synthetic HCI commands are passed to
+ * mesh_app_proc_rx_cmd and answered by the servers of the simulated mesh, and synthetic
+ * statuses are passed to the Light CTL Client callback. Times include the simulated mesh.
+ * Each phase reports the rate and time per command or status, the commands which were not sent,
+ * and the messages and bytes encoded for the mesh and for the host.
+ *
+ * Usage: bench [commands [statuses]]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mesh_sim.h"
+#include "mesh_light_ctl_codec.h"
+#include "mesh_light_ctl_hci.h"
+
+/******************************************************
+ *          Constants
+ ******************************************************/
+#define BENCH_COMMANDS          2000000
+#define BENCH_STATUSES          2000000
+#define BENCH_COMMANDS_PER_MS   4           // Commands sent between two steps of the simulated clock
+
+/******************************************************
+ *          Structures
+ ******************************************************/
+typedef struct
+{
+    double   seconds;
+    uint64_t count;
+    uint64_t mesh_messages;
+    uint64_t mesh_bytes;
+    uint64_t hci_bytes;
+    uint64_t refused;                       // Commands not accepted, or tracked requests completed without room in the request table
+} bench_result_t;
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static void bench_commands(uint32_t count, bench_result_t *p_result);
+static void bench_statuses(uint32_t count, bench_result_t *p_result);
+static uint32_t bench_command(uint8_t *p_buffer, uint32_t i, uint16_t *p_opcode);
+static double bench_time(void);
+static void bench_print(const char *p_name, const bench_result_t *p_result);
+static void bench_hci_event(uint16_t opcode, const uint8_t *p_data, uint16_t length);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+static mesh_sim_config_t bench_config;
+static uint64_t bench_refused;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int main(int argc, char *argv[])
+{
+    bench_result_t result;
+    uint32_t commands = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_COMMANDS;
+    uint32_t statuses = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : BENCH_STATUSES;
+    uint8_t request_config[4] = { 8, 0xE8, 0x03, 1 };      // Window 8, timeout 1000 ms, 1 retry
+
+    mesh_sim_config_default(&bench_config);
+    mesh_sim_init(&bench_config);
+    mesh_sim_set_hci_callback(bench_hci_event);
+
+    printf("%-10s %10s %9s %12s %9s %9s %12s %12s %12s\n", "phase", "count", "seconds", "per second", "ns each", "refused", "mesh msgs", "mesh bytes", "hci bytes");
+
+    bench_commands(commands, &result);
+    bench_print("commands", &result);
+
+    mesh_sim_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG, request_config, sizeof(request_config));
+    bench_commands(commands, &result);
+    bench_print("tracked", &result);
+
+    bench_statuses(statuses, &result);
+    bench_print("statuses", &result);
+
+    // Everything sent must complete and give its event back
+    mesh_sim_run(60000);
+    if ((mesh_sim_stats.events_in_use != 0) || (mesh_sim_pending() != 0))
+    {
+        printf("events not released:%u pending:%u\n", mesh_sim_stats.events_in_use, mesh_sim_pending());
+        return 1;
+    }
+    printf("events high water:%u event failures:%llu\n", mesh_sim_stats.events_high_water, (unsigned long long)mesh_sim_stats.event_failures);
+    return 0;
+}
+
+/*
+ * Send count commands to the servers, moving the simulated clock so that statuses come back
+ */
+void bench_commands(uint32_t count, bench_result_t *p_result)
+{
+    uint8_t buffer[64];
+    uint16_t opcode;
+    uint32_t length;
+    uint32_t i;
+    mesh_sim_stats_t start = mesh_sim_stats;
+    uint64_t start_refused = bench_refused;
+    double start_time = bench_time();
+
+    for (i = 0; i < count; i++)
+    {
+        length = bench_command(buffer, i, &opcode);
+        mesh_sim_command(opcode, buffer, length);
+        if ((i % BENCH_COMMANDS_PER_MS) == BENCH_COMMANDS_PER_MS - 1)
+            mesh_sim_run(1);
+    }
+    mesh_sim_run(5000);
+
+    p_result->seconds       = bench_time() - start_time;
+    p_result->count         = count;
+    p_result->mesh_messages = mesh_sim_stats.mesh_messages - start.mesh_messages;
+    p_result->mesh_bytes    = mesh_sim_stats.mesh_bytes - start.mesh_bytes;
+    p_result->hci_bytes     = mesh_sim_stats.hci_bytes - start.hci_bytes;
+    p_result->refused       = bench_refused - start_refused;
+}
+
+/*
+ * Pass count statuses from the servers to the client, alternating Light CTL and temperature statuses
+ */
+void bench_statuses(uint32_t count, bench_result_t *p_result)
+{
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    uint32_t i;
+    mesh_sim_stats_t start = mesh_sim_stats;
+    uint64_t start_refused = bench_refused;
+    double start_time = bench_time();
+
+    memset(&status, 0, sizeof(status));
+    for (i = 0; i < count; i++)
+    {
+        status.present.lightness   = (uint16_t)(i * 7);
+        status.present.temperature = (uint16_t)(800 + (i % 19200));
+        status.target              = status.present;
+        mesh_sim_status((i & 1) ? WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS : WICED_BT_MESH_LIGHT_CTL_STATUS,
+                MESH_SIM_SERVER(i % bench_config.num_servers), &status);
+        if ((i & 0xFF) == 0xFF)
+            mesh_sim_run(1);
+    }
+    mesh_sim_run(5000);
+
+    p_result->seconds       = bench_time() - start_time;
+    p_result->count         = count;
+    p_result->mesh_messages = mesh_sim_stats.mesh_messages - start.mesh_messages;
+    p_result->mesh_bytes    = mesh_sim_stats.mesh_bytes - start.mesh_bytes;
+    p_result->hci_bytes     = mesh_sim_stats.hci_bytes - start.hci_bytes;
+    p_result->refused       = bench_refused - start_refused;
+}
+
+/*
+ * Build command i of the mix: set, get, temperature set, temperature get and default get,
+ * each to the next server
+ */
+uint32_t bench_command(uint8_t *p_buffer, uint32_t i, uint16_t *p_opcode)
+{
+    static const uint8_t mix[] =
+    {
+        MESH_LIGHT_CTL_CODEC_SET,
+        MESH_LIGHT_CTL_CODEC_GET,
+        MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET,
+        MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET,
+        MESH_LIGHT_CTL_CODEC_DEFAULT_GET,
+    };
+    const mesh_light_ctl_codec_message_t *p_msg = &mesh_light_ctl_codec_messages[mix[i % sizeof(mix)]];
+    union
+    {
+        mesh_light_ctl_codec_get_t                  get;
+        wiced_bt_mesh_light_ctl_set_t               set;
+        wiced_bt_mesh_light_ctl_temperature_set_t   temperature_set;
+    } params;
+    uint32_t length;
+
+    memset(&params, 0, sizeof(params));
+    if (p_msg->opcode == HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET)
+    {
+        params.set.target.lightness   = (uint16_t)(i * 13);
+        params.set.target.temperature = (uint16_t)(800 + (i % 19200));
+    }
+    else if (p_msg->opcode == HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET)
+    {
+        params.temperature_set.target_temperature = (uint16_t)(800 + (i % 19200));
+    }
+    *p_opcode = p_msg->opcode;
+    length = mesh_sim_command_hdr(p_buffer, MESH_SIM_SERVER(i % bench_config.num_servers), 0, WICED_TRUE, 0);
+    return length + mesh_light_ctl_codec_encode(p_msg, &params, p_buffer + length, 64 - length);
+}
+
+double bench_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+void bench_print(const char *p_name, const bench_result_t *p_result)
+{
+    printf("%-10s %10llu %9.3f %12.0f %9.1f %9llu %12llu %12llu %12llu\n", p_name, (unsigned long long)p_result->count, p_result->seconds,
+            p_result->count / p_result->seconds, p_result->seconds * 1e9 / p_result->count, (unsigned long long)p_result->refused,
+            (unsigned long long)p_result->mesh_messages, (unsigned long long)p_result->mesh_bytes, (unsigned long long)p_result->hci_bytes);
+}
+
+/*
+ * Count the commands which the client did not send
+ */
+void bench_hci_event(uint16_t opcode, const uint8_t *p_data, uint16_t length)
+{
+    if (opcode == HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)
+        bench_refused++;
+    else if ((opcode == HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE) && (length > 6) && (p_data[6] == MESH_LIGHT_CTL_CLIENT_RESULT_NO_RESOURCES))
+        bench_refused++;
+}
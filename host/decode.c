@@ -0,0 +1,150 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Print the binary trace records or the capture read from the Light CTL Client over AIROC HCI.
+ * A trace file holds the data of HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TRACE_DATA events one after the
+ * other. A capture file holds the capture bytes in offset order, as for replay.
+ *
+ * Usage: decode trace|capture file
+ */
+#include <stdio.h>
+#include <string.h>
+#include "hci_decode.h"
+#include "mesh_light_ctl_hci.h"
+
+/******************************************************
+ *          Constants
+ ******************************************************/
+#define DECODE_MAX_FILE         0x100000
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static int decode_trace(const uint8_t *p_data, uint32_t length);
+static int decode_capture(const uint8_t *p_data, uint32_t length);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+static uint8_t decode_file[DECODE_MAX_FILE];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t length;
+    FILE *p_file;
+
+    if ((argc < 3) || ((strcmp(argv[1], "trace") != 0) && (strcmp(argv[1], "capture") != 0)))
+    {
+        printf("usage: %s trace|capture file\n", argv[0]);
+        return 2;
+    }
+    if ((p_file = fopen(argv[2], "rb")) == NULL)
+    {
+        perror(argv[2]);
+        return 2;
+    }
+    length = (uint32_t)fread(decode_file, 1, sizeof(decode_file), p_file);
+    fclose(p_file);
+
+    return (strcmp(argv[1], "trace") == 0) ? decode_trace(decode_file, length) : decode_capture(decode_file, length);
+}
+
+/*
+ * Print the records of each trace data event with the tick count, as the client prints them
+ */
+int decode_trace(const uint8_t *p_data, uint32_t length)
+{
+    hci_decode_trace_t records[MESH_LIGHT_CTL_TRACE_DATA_RECORDS];
+    char text[160];
+    uint32_t event_len, count, i;
+    uint16_t dropped;
+
+    while (length != 0)
+    {
+        event_len = hci_decode_trace_data_len(p_data, length);
+        if ((event_len == HCI_DECODE_ERROR) || (event_len > length) ||
+            ((count = hci_decode_trace_data(p_data, event_len, &dropped, records, MESH_LIGHT_CTL_TRACE_DATA_RECORDS)) == HCI_DECODE_ERROR))
+        {
+            printf("truncated trace data, %u bytes left\n", length);
+            return 1;
+        }
+        if (dropped != 0)
+            printf("ctl trace dropped:%d\n", dropped);
+        for (i = 0; i < count; i++)
+        {
+            hci_decode_trace_format(text, sizeof(text), &records[i]);
+            printf("%u: %s", records[i].time, text);
+        }
+        p_data += event_len;
+        length -= event_len;
+    }
+    return 0;
+}
+
+/*
+ * Print each capture record with the time since the start of the capture
+ */
+int decode_capture(const uint8_t *p_data, uint32_t length)
+{
+    static const char *types[] = { "command", "event", "mesh" };
+    hci_decode_capture_t record;
+    uint32_t record_len;
+    uint32_t time = 0;
+    uint16_t i;
+
+    while (length != 0)
+    {
+        if ((record_len = hci_decode_capture(p_data, length, &record)) == 0)
+        {
+            printf("truncated capture, %u bytes left\n", length);
+            return 1;
+        }
+        time += record.delta;
+        printf("%u: %s opcode:%04x len:%d", time, (record.type < 3) ? types[record.type] : "unknown", record.opcode, record.length);
+        if (record.p_data != NULL)
+        {
+            printf(" data:");
+            for (i = 0; i < record.length; i++)
+                printf("%02x", record.p_data[i]);
+        }
+        printf("\n");
+        p_data += record_len;
+        length -= record_len;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Decoding of the binary trace records and of the capture read from the Light CTL Client
+ */
+#include <stdio.h>
+#include "hci_decode.h"
+#include "mesh_light_ctl_hci.h"
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+// Format of each trace id
+static const char *hci_decode_trace_formats[MESH_LIGHT_CTL_TRACE_NUM_IDS] =
+{
+    [MESH_LIGHT_CTL_TRACE_MSG]                  = MESH_LIGHT_CTL_TRACE_MSG_FMT,
+    [MESH_LIGHT_CTL_TRACE_TX_COMPLETE]          = MESH_LIGHT_CTL_TRACE_TX_COMPLETE_FMT,
+    [MESH_LIGHT_CTL_TRACE_STATUS]               = MESH_LIGHT_CTL_TRACE_STATUS_FMT,
+    [MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS]       = MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS_FMT,
+    [MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS]   = MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS_FMT,
+    [MESH_LIGHT_CTL_TRACE_RANGE_STATUS]         = MESH_LIGHT_CTL_TRACE_RANGE_STATUS_FMT,
+    [MESH_LIGHT_CTL_TRACE_CACHE_REPLY]          = MESH_LIGHT_CTL_TRACE_CACHE_REPLY_FMT,
+    [MESH_LIGHT_CTL_TRACE_REQUEST_FAILED]       = MESH_LIGHT_CTL_TRACE_REQUEST_FAILED_FMT,
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+uint32_t hci_decode_trace_data(const uint8_t *p_data, uint32_t length, uint16_t *p_dropped, hci_decode_trace_t *p_records, uint32_t max_records)
+{
+    const uint8_t *p = p_data;
+    uint8_t count;
+    uint32_t i, j;
+
+    if (hci_decode_trace_data_len(p_data, length) != length)
+        return HCI_DECODE_ERROR;
+
+    STREAM_TO_UINT16(*p_dropped, p);
+    STREAM_TO_UINT8(count, p);
+    if (count > max_records)
+        return HCI_DECODE_ERROR;
+
+    for (i = 0; i < count; i++)
+    {
+        STREAM_TO_UINT32(p_records[i].time, p);
+        STREAM_TO_UINT8(p_records[i].id, p);
+        for (j = 0; j < 5; j++)
+            STREAM_TO_UINT32(p_records[i].arg[j], p);
+    }
+    return count;
+}
+
+uint32_t hci_decode_trace_data_len(const uint8_t *p_data, uint32_t length)
+{
+    if (length < MESH_LIGHT_CTL_TRACE_DATA_HDR_LEN)
+        return HCI_DECODE_ERROR;
+
+    return MESH_LIGHT_CTL_TRACE_DATA_HDR_LEN + p_data[2] * MESH_LIGHT_CTL_TRACE_RECORD_LEN;
+}
+
+int hci_decode_trace_format(char *p_buffer, size_t size, const hci_decode_trace_t *p_record)
+{
+    const uint32_t *p_arg = p_record->arg;
+
+    if ((p_record->id >= MESH_LIGHT_CTL_TRACE_NUM_IDS) || (hci_decode_trace_formats[p_record->id] == NULL))
+        return snprintf(p_buffer, size, "trace id:%d\n", p_record->id);
+
+    // The client prints the arguments as int, unused arguments are 0 and not printed
+    return snprintf(p_buffer, size, hci_decode_trace_formats[p_record->id],
+            (int)p_arg[0], (int)p_arg[1], (int)p_arg[2], (int)p_arg[3], (int)p_arg[4]);
+}
+
+uint32_t hci_decode_capture(const uint8_t *p_data, uint32_t length, hci_decode_capture_t *p_record)
+{
+    const uint8_t *p = p_data;
+
+    if (length < MESH_LIGHT_CTL_CAPTURE_HDR_LEN)
+        return 0;
+
+    STREAM_TO_UINT8(p_record->type, p);
+    STREAM_TO_UINT16(p_record->delta, p);
+    STREAM_TO_UINT16(p_record->opcode, p);
+    STREAM_TO_UINT16(p_record->length, p);
+    if (p_record->type == MESH_LIGHT_CTL_CAPTURE_EVENT)
+    {
+        p_record->p_data = NULL;
+        return MESH_LIGHT_CTL_CAPTURE_HDR_LEN;
+    }
+    if (length - MESH_LIGHT_CTL_CAPTURE_HDR_LEN < p_record->length)
+        return 0;
+
+    p_record->p_data = p;
+    return MESH_LIGHT_CTL_CAPTURE_HDR_LEN + p_record->length;
+}
@@ -0,0 +1,88 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Decoding of the binary trace records and of the capture read from the Light CTL Client over
+ * AIROC HCI. The layouts, trace ids and formats are the ones of mesh_light_ctl_hci.h.
+ */
+#ifndef HCI_DECODE_H
+#define HCI_DECODE_H
+
+#include <stddef.h>
+#include "wiced_bt_types.h"
+
+#define HCI_DECODE_ERROR            0xFFFFFFFF
+
+// Trace record of HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TRACE_DATA
+typedef struct
+{
+    uint32_t time;                              // Tick count in ms when the trace was stored
+    uint8_t  id;                                // MESH_LIGHT_CTL_TRACE_xxx
+    uint32_t arg[5];
+} hci_decode_trace_t;
+
+// Capture record, the data points into the capture
+typedef struct
+{
+    uint8_t  type;                              // MESH_LIGHT_CTL_CAPTURE_xxx
+    uint16_t delta;                             // ms since the previous record
+    uint16_t opcode;
+    uint16_t length;                            // Length of the command, event or mesh data
+    const uint8_t *p_data;                      // NULL for events, which are captured without their data
+} hci_decode_capture_t;
+
+/*
+ * Decode the data of one trace data event into p_records. Returns the number of records, or
+ * HCI_DECODE_ERROR if the length does not match the number of records or there are more than max_records.
+ */
+uint32_t hci_decode_trace_data(const uint8_t *p_data, uint32_t length, uint16_t *p_dropped, hci_decode_trace_t *p_records, uint32_t max_records);
+
+/*
+ * Length of the trace data event at p_data, HCI_DECODE_ERROR if length is shorter than its header
+ */
+uint32_t hci_decode_trace_data_len(const uint8_t *p_data, uint32_t length);
+
+/*
+ * Format a trace record as the client prints it, without the tick count. Returns the length of the
+ * text as snprintf does.
+ */
+int hci_decode_trace_format(char *p_buffer, size_t size, const hci_decode_trace_t *p_record);
+
+/*
+ * Decode the capture record at p_data. Returns the length of the record, 0 if length is shorter
+ * than the record.
+ */
+uint32_t hci_decode_capture(const uint8_t *p_data, uint32_t length, hci_decode_capture_t *p_record);
+
+#endif // HCI_DECODE_H
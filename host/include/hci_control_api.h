@@ -0,0 +1,58 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Host build: WICED HCI opcodes of the Light CTL Client.
+ */
+#ifndef HCI_CONTROL_API_H
+#define HCI_CONTROL_API_H
+
+#define HCI_CONTROL_GROUP_MESH                                      0x16
+
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET                      ((HCI_CONTROL_GROUP_MESH << 8) | 0x80)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET                      ((HCI_CONTROL_GROUP_MESH << 8) | 0x81)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET          ((HCI_CONTROL_GROUP_MESH << 8) | 0x82)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET          ((HCI_CONTROL_GROUP_MESH << 8) | 0x83)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET    ((HCI_CONTROL_GROUP_MESH << 8) | 0x84)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET    ((HCI_CONTROL_GROUP_MESH << 8) | 0x85)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET              ((HCI_CONTROL_GROUP_MESH << 8) | 0x86)
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET              ((HCI_CONTROL_GROUP_MESH << 8) | 0x87)
+
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS                     ((HCI_CONTROL_GROUP_MESH << 8) | 0x80)
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_STATUS         ((HCI_CONTROL_GROUP_MESH << 8) | 0x81)
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_RANGE_STATUS   ((HCI_CONTROL_GROUP_MESH << 8) | 0x82)
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_DEFAULT_STATUS             ((HCI_CONTROL_GROUP_MESH << 8) | 0x83)
+#define HCI_CONTROL_MESH_EVENT_TX_COMPLETE                          ((HCI_CONTROL_GROUP_MESH << 8) | 0x01)
+
+#endif // HCI_CONTROL_API_H
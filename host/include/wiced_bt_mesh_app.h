@@ -0,0 +1,72 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Host build: interface between the mesh application library and the application.
+ */
+#ifndef WICED_BT_MESH_APP_H
+#define WICED_BT_MESH_APP_H
+
+#include "wiced_bt_ble.h"
+#include "wiced_bt_mesh_core.h"
+
+typedef void (*wiced_bt_mesh_app_init_t)(wiced_bool_t is_provisioned);
+typedef wiced_bool_t (*wiced_bt_mesh_app_hardware_init_t)(void);
+typedef void (*wiced_bt_mesh_app_gatt_conn_status_t)(void *p_status);
+typedef void (*wiced_bt_mesh_app_attention_t)(uint8_t element_idx, uint8_t time);
+typedef void (*wiced_bt_mesh_app_notify_period_set_t)(uint8_t element_idx, uint16_t company_id, uint16_t model_id, uint32_t period);
+typedef uint32_t (*wiced_bt_mesh_app_proc_rx_cmd_t)(uint16_t opcode, uint8_t *p_data, uint32_t length);
+typedef void (*wiced_bt_mesh_app_lpn_sleep_t)(uint32_t max_sleep_duration);
+typedef void (*wiced_bt_mesh_app_factory_reset_t)(void);
+
+typedef struct
+{
+    wiced_bt_mesh_app_init_t                p_mesh_app_init;
+    wiced_bt_mesh_app_hardware_init_t       p_mesh_app_hw_init;
+    wiced_bt_mesh_app_gatt_conn_status_t    p_mesh_app_gatt_conn_status;
+    wiced_bt_mesh_app_attention_t           p_mesh_app_attention;
+    wiced_bt_mesh_app_notify_period_set_t   p_mesh_app_notify_period_set;
+    wiced_bt_mesh_app_proc_rx_cmd_t         p_mesh_app_proc_rx_cmd;
+    wiced_bt_mesh_app_lpn_sleep_t           p_mesh_app_lpn_sleep;
+    wiced_bt_mesh_app_factory_reset_t       p_mesh_app_factory_reset;
+} wiced_bt_mesh_app_func_table_t;
+
+void wiced_bt_mesh_set_raw_scan_response_data(uint8_t num_elem, wiced_bt_ble_advert_elem_t *p_data);
+
+/*
+ * Send an event to the host, collected by the host harness
+ */
+wiced_result_t mesh_transport_send_data(uint16_t opcode, uint8_t *p_data, uint16_t length);
+
+#endif // WICED_BT_MESH_APP_H
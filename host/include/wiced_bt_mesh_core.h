@@ -0,0 +1,123 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Host build: mesh core configuration and services used by the application.
+ */
+#ifndef WICED_BT_MESH_CORE_H
+#define WICED_BT_MESH_CORE_H
+
+#include "wiced_bt_types.h"
+
+#define MESH_COMPANY_ID_BT_SIG                          0x0000
+#define MESH_COMPANY_ID_CYPRESS                         0x0131
+
+#define WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT      0x1305
+
+#define WICED_BT_MESH_CORE_FEATURE_BIT_RELAY            0x0001
+#define WICED_BT_MESH_CORE_FEATURE_BIT_GATT_PROXY_SERVER 0x0002
+#define WICED_BT_MESH_CORE_FEATURE_BIT_FRIEND           0x0004
+#define WICED_BT_MESH_CORE_FEATURE_BIT_LOW_POWER        0x0008
+
+#define WICED_BT_MESH_PROPERTY_LEN_DEVICE_MANUFACTURER_NAME 8
+#define WICED_BT_MESH_PROPERTY_LEN_DEVICE_MODEL_NUMBER      8
+
+#define MESH_ELEM_LOC_MAIN                              0x0106
+#define MESH_DEFAULT_TRANSITION_TIME_IN_MS              0
+#define WICED_BT_MESH_ON_POWER_UP_STATE_RESTORE         2
+
+// Transmission status reported in the TX complete event
+#define TX_STATUS_COMPLETED                             0
+#define TX_STATUS_FAILED                                1
+#define TX_STATUS_ACK_RECEIVED                          2
+
+typedef struct
+{
+    uint16_t    company_id;
+    uint16_t    model_id;
+    void       *p_message_handler;      // Not used by the simulated mesh
+} wiced_bt_mesh_core_config_model_t;
+
+typedef struct
+{
+    uint16_t    location;
+    uint32_t    default_transition_time;
+    uint8_t     onpowerup_state;
+    uint16_t    default_level;
+    uint16_t    range_min;
+    uint16_t    range_max;
+    uint8_t     move_rollover;
+    uint8_t     properties_num;
+    void       *properties;
+    uint8_t     sensors_num;
+    void       *sensors;
+    uint8_t     models_num;
+    wiced_bt_mesh_core_config_model_t *models;
+} wiced_bt_mesh_core_config_element_t;
+
+typedef struct
+{
+    uint32_t    receive_window;
+    uint32_t    cache_buf_len;
+    uint32_t    max_lpn_num;
+} wiced_bt_mesh_core_config_friend_t;
+
+typedef struct
+{
+    uint8_t     rssi_factor;
+    uint8_t     receive_window_factor;
+    uint8_t     min_cache_size_log;
+    uint8_t     receive_delay;
+    uint32_t    poll_timeout;
+} wiced_bt_mesh_core_config_low_power_t;
+
+typedef struct
+{
+    uint16_t    company_id;
+    uint16_t    product_id;
+    uint16_t    vendor_id;
+    uint16_t    features;
+    wiced_bt_mesh_core_config_friend_t      friend_cfg;
+    wiced_bt_mesh_core_config_low_power_t   low_power;
+    wiced_bool_t gatt_client_only;
+    uint8_t     elements_num;
+    wiced_bt_mesh_core_config_element_t *elements;
+} wiced_bt_mesh_core_config_t;
+
+/*
+ * Simulated time in ms since the start of the host harness
+ */
+uint32_t wiced_bt_mesh_core_get_tick_count(void);
+
+#endif // WICED_BT_MESH_CORE_H
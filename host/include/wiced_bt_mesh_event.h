@@ -0,0 +1,92 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Host build: mesh events exchanged between the application and the models.
+ */
+#ifndef WICED_BT_MESH_EVENT_H
+#define WICED_BT_MESH_EVENT_H
+
+#include "wiced_bt_types.h"
+
+typedef struct
+{
+    uint8_t     tx_flag;                // TX_STATUS_xxx of a TX complete event
+} wiced_bt_mesh_event_status_t;
+
+typedef struct wiced_bt_mesh_event_t
+{
+    uint16_t    opcode;
+    uint16_t    company_id;
+    uint16_t    model_id;
+    uint8_t     element_idx;
+    uint16_t    src;
+    uint16_t    dst;
+    uint16_t    app_key_idx;
+    uint8_t     ttl;
+    uint8_t     retrans_cnt;            // Number of retransmissions by the model while a reply is expected
+    uint8_t     retrans_time;           // Interval between retransmissions in 50 ms units
+    uint8_t     reply;                  // A status is expected
+    uint8_t     send_segmented;
+    uint32_t    reply_timeout;          // Time in ms to wait for the reply
+    wiced_bt_mesh_event_status_t status;
+} wiced_bt_mesh_event_t;
+
+// Header of an event to the host, the event data follows
+typedef struct
+{
+    uint16_t    src;
+    uint16_t    app_key_idx;
+    uint8_t     element_idx;
+    uint8_t     data[1];
+} __attribute__((packed)) wiced_bt_mesh_hci_event_t;
+
+/*
+ * Take an event from the pool of the simulated mesh, NULL if all events are in use
+ */
+wiced_bt_mesh_event_t *wiced_bt_mesh_create_event(uint8_t element_idx, uint16_t company_id, uint16_t model_id, uint16_t dst, uint16_t app_key_idx);
+
+/*
+ * Take an event and fill it from the header of an HCI command: destination (2 bytes), application
+ * key index (2 bytes), element index, reply, send segmented, TTL, retransmit count, retransmit
+ * interval and reply timeout (1 byte each). The data pointer and length are moved past the header.
+ */
+wiced_bt_mesh_event_t *wiced_bt_mesh_create_event_from_wiced_hci(uint16_t opcode, uint16_t company_id, uint16_t model_id, uint8_t **p_data, uint32_t *len);
+
+void wiced_bt_mesh_release_event(wiced_bt_mesh_event_t *p_event);
+
+wiced_bt_mesh_hci_event_t *wiced_bt_mesh_create_hci_event(wiced_bt_mesh_event_t *p_event);
+void wiced_bt_mesh_send_hci_tx_complete(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_event_t *p_event);
+
+#endif // WICED_BT_MESH_EVENT_H
@@ -0,0 +1,117 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Host build: Light CTL Client model. Messages sent by the application are delivered to
+ * the simulated Light CTL Servers of the host harness.
+ */
+#ifndef WICED_BT_MESH_MODELS_H
+#define WICED_BT_MESH_MODELS_H
+
+#include "wiced_bt_mesh_core.h"
+#include "wiced_bt_mesh_event.h"
+
+#define WICED_BT_MESH_DEVICE \
+    { MESH_COMPANY_ID_BT_SIG, 0x0000, NULL }
+#define WICED_BT_MESH_MODEL_LIGHT_CTL_CLIENT \
+    { MESH_COMPANY_ID_BT_SIG, WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT, NULL }
+
+// Events passed to the Light CTL Client callback
+#define WICED_BT_MESH_TX_COMPLETE                           0
+#define WICED_BT_MESH_LIGHT_CTL_STATUS                      1
+#define WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS          2
+#define WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS    3
+#define WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS              4
+
+typedef struct
+{
+    uint16_t    lightness;
+    uint16_t    temperature;
+    uint16_t    delta_uv;
+} wiced_bt_mesh_light_ctl_data_t;
+
+typedef struct
+{
+    wiced_bt_mesh_light_ctl_data_t  present;
+    wiced_bt_mesh_light_ctl_data_t  target;
+    uint32_t                        remaining_time;
+} wiced_bt_mesh_light_ctl_status_data_t;
+
+typedef struct
+{
+    wiced_bt_mesh_light_ctl_data_t  target;
+    uint32_t                        transition_time;
+    uint16_t                        delay;
+} wiced_bt_mesh_light_ctl_set_t;
+
+typedef struct
+{
+    uint16_t    target_temperature;
+    uint16_t    target_delta_uv;
+    uint32_t    transition_time;
+    uint16_t    delay;
+} wiced_bt_mesh_light_ctl_temperature_set_t;
+
+typedef struct
+{
+    wiced_bt_mesh_light_ctl_data_t  default_status;
+} wiced_bt_mesh_light_ctl_default_data_t;
+
+typedef struct
+{
+    uint16_t    min_level;
+    uint16_t    max_level;
+} wiced_bt_mesh_light_ctl_temperature_range_data_t;
+
+typedef struct
+{
+    uint8_t     status;
+    uint16_t    min_level;
+    uint16_t    max_level;
+} wiced_bt_mesh_light_ctl_temperature_range_status_data_t;
+
+typedef void (wiced_bt_mesh_light_ctl_client_callback_t)(uint16_t event, wiced_bt_mesh_event_t *p_event, void *p_data);
+
+void wiced_bt_mesh_model_light_ctl_client_init(uint8_t element_idx, wiced_bt_mesh_light_ctl_client_callback_t *p_callback, wiced_bool_t is_provisioned);
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_get(wiced_bt_mesh_event_t *p_event);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_set_t *p_set);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_get(wiced_bt_mesh_event_t *p_event);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_temperature_set_t *p_set);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_range_get(wiced_bt_mesh_event_t *p_event);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_range_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_temperature_range_data_t *p_set);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_default_get(wiced_bt_mesh_event_t *p_event);
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_default_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_default_data_t *p_set);
+
+#endif // WICED_BT_MESH_MODELS_H
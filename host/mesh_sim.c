@@ -0,0 +1,855 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Simulated mesh for host builds of the Light CTL Client, see mesh_sim.h.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "wiced_bt_cfg.h"
+#include "wiced_bt_trace.h"
+#include "wiced_hal_nvram.h"
+#include "wiced_hal_rand.h"
+#include "wiced_timer.h"
+#include "hci_control_api.h"
+#include "mesh_sim.h"
+
+/******************************************************
+ *          Constants
+ ******************************************************/
+#define MESH_SIM_NVRAM_ITEMS        64
+#define MESH_SIM_NVRAM_ITEM_LEN     512
+#define MESH_SIM_CLIENT_ELEMENTS    8
+#define MESH_SIM_RETRANS_UNIT       50          // Unit of the retransmit interval in the mesh header in ms
+#define MESH_SIM_RETRANS_DEFAULT    200         // Retransmit interval in ms if the header does not give one
+
+// Access payload length of Light CTL messages, 2 byte opcode included
+#define MESH_SIM_LEN_GET            2
+#define MESH_SIM_LEN_SET            9           // Lightness, temperature, delta UV, TID
+#define MESH_SIM_LEN_TEMPERATURE_SET 7          // Temperature, delta UV, TID
+#define MESH_SIM_LEN_TRANSITION     2           // Optional transition time and delay
+#define MESH_SIM_LEN_RANGE_SET      6
+#define MESH_SIM_LEN_DEFAULT_SET    8
+
+/******************************************************
+ *          Structures
+ ******************************************************/
+// Message on its way to the client
+typedef struct
+{
+    uint32_t due_time;
+    uint32_t seq;                               // Keeps the order of deliveries due at the same time
+    uint16_t event;                             // WICED_BT_MESH_xxx passed to the client callback
+    uint16_t src;                               // Server sending a status
+    uint8_t  element_idx;                       // Client element receiving a status
+    uint8_t  tx_flag;                           // TX_STATUS_xxx of a TX complete
+    uint16_t app_key_idx;
+    wiced_bt_mesh_event_t *p_event;             // Event of the message returned in its TX complete
+} mesh_sim_delivery_t;
+
+typedef struct
+{
+    uint16_t vs_id;
+    uint16_t length;                            // 0 if the item is not used
+    uint8_t  data[MESH_SIM_NVRAM_ITEM_LEN];
+} mesh_sim_nvram_t;
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static wiced_result_t mesh_sim_send(wiced_bt_mesh_event_t *p_event, uint16_t reply_event, uint8_t length, uint16_t opcode, const void *p_params);
+static void mesh_sim_server_receive(mesh_sim_server_t *p_server, uint16_t opcode, const void *p_params);
+static void mesh_sim_deliver(mesh_sim_delivery_t *p_delivery);
+static void mesh_sim_push(mesh_sim_delivery_t *p_delivery);
+static void mesh_sim_pop(mesh_sim_delivery_t *p_delivery);
+static uint32_t mesh_sim_rand(void);
+static void mesh_sim_timer_remove(wiced_timer_t *p_timer);
+static mesh_sim_server_t *mesh_sim_server_find(uint16_t addr);
+static mesh_sim_nvram_t *mesh_sim_nvram_find(uint16_t vs_id);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+extern wiced_bt_mesh_app_func_table_t wiced_bt_mesh_app_func_table;
+
+wiced_bt_cfg_settings_t wiced_bt_cfg_settings;
+
+mesh_sim_stats_t  mesh_sim_stats;
+mesh_sim_server_t mesh_sim_servers[MESH_SIM_MAX_SERVERS];
+
+static mesh_sim_config_t mesh_sim_config;
+static uint32_t mesh_sim_now = 0;
+static uint32_t mesh_sim_seq = 0;
+static uint32_t mesh_sim_rand_state = 1;
+static uint32_t mesh_sim_app_rand_state = 1;
+static wiced_timer_t *mesh_sim_timers = NULL;   // Started timers
+static mesh_sim_hci_callback_t mesh_sim_hci_callback = NULL;
+static wiced_bt_mesh_light_ctl_client_callback_t *mesh_sim_client_callback[MESH_SIM_CLIENT_ELEMENTS];
+
+// Pool of mesh events, free events are kept on a stack
+static wiced_bt_mesh_event_t mesh_sim_events[MESH_SIM_MAX_EVENTS];
+static uint8_t  mesh_sim_event_used[MESH_SIM_MAX_EVENTS];
+static uint16_t mesh_sim_event_free[MESH_SIM_MAX_EVENTS];
+static uint16_t mesh_sim_event_free_count = 0;
+
+// Deliveries ordered by due time in a binary heap
+static mesh_sim_delivery_t *mesh_sim_heap = NULL;
+static uint32_t mesh_sim_heap_count = 0;
+static uint32_t mesh_sim_heap_size = 0;
+
+static mesh_sim_nvram_t mesh_sim_nvram[MESH_SIM_NVRAM_ITEMS];
+
+static uint8_t mesh_sim_hci_event[64];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+void mesh_sim_config_default(mesh_sim_config_t *p_config)
+{
+    memset(p_config, 0, sizeof(*p_config));
+    p_config->num_servers    = 64;
+    p_config->num_events     = 48;
+    p_config->tx_time        = 2;
+    p_config->reply_time     = 4;
+    p_config->seed           = 1;
+    p_config->is_provisioned = WICED_TRUE;
+}
+
+void mesh_sim_init(const mesh_sim_config_t *p_config)
+{
+    uint16_t i;
+
+    mesh_sim_config = *p_config;
+    if (mesh_sim_config.num_servers > MESH_SIM_MAX_SERVERS)
+        mesh_sim_config.num_servers = MESH_SIM_MAX_SERVERS;
+    if (mesh_sim_config.num_events > MESH_SIM_MAX_EVENTS)
+        mesh_sim_config.num_events = MESH_SIM_MAX_EVENTS;
+
+    memset(&mesh_sim_stats, 0, sizeof(mesh_sim_stats));
+    mesh_sim_now  = 0;
+    mesh_sim_seq  = 0;
+    mesh_sim_rand_state     = (p_config->seed != 0) ? p_config->seed : 1;
+    mesh_sim_app_rand_state = mesh_sim_rand_state ^ 0x5A5A5A5A;
+    mesh_sim_heap_count = 0;
+
+    memset(mesh_sim_event_used, 0, sizeof(mesh_sim_event_used));
+    mesh_sim_event_free_count = 0;
+    for (i = mesh_sim_config.num_events; i > 0; i--)
+        mesh_sim_event_free[mesh_sim_event_free_count++] = i - 1;
+
+    for (i = 0; i < MESH_SIM_MAX_SERVERS; i++)
+    {
+        memset(&mesh_sim_servers[i], 0, sizeof(mesh_sim_servers[i]));
+        mesh_sim_servers[i].present.temperature       = 2700;
+        mesh_sim_servers[i].default_state.lightness   = 0xFFFF;
+        mesh_sim_servers[i].default_state.temperature = 2700;
+        mesh_sim_servers[i].range_min                 = 800;
+        mesh_sim_servers[i].range_max                 = 20000;
+    }
+
+    wiced_bt_mesh_app_func_table.p_mesh_app_init(mesh_sim_config.is_provisioned);
+}
+
+uint32_t mesh_sim_command(uint16_t opcode, const uint8_t *p_data, uint32_t length)
+{
+    uint8_t buffer[512];
+
+    // The application gets its own copy as it would from the transport
+    if (length > sizeof(buffer))
+        return WICED_FALSE;
+    memcpy(buffer, p_data, length);
+
+    mesh_sim_stats.commands++;
+    mesh_sim_stats.command_bytes += length;
+    return wiced_bt_mesh_app_func_table.p_mesh_app_proc_rx_cmd(opcode, buffer, length);
+}
+
+uint32_t mesh_sim_command_hdr(uint8_t *p_buffer, uint16_t dst, uint8_t element_idx, wiced_bool_t reply, uint8_t retrans_cnt)
+{
+    uint8_t *p = p_buffer;
+
+    UINT16_TO_STREAM(p, dst);
+    UINT16_TO_STREAM(p, 0);             // Application key index
+    UINT8_TO_STREAM(p, element_idx);
+    UINT8_TO_STREAM(p, reply);
+    UINT8_TO_STREAM(p, 0);              // Send segmented
+    UINT8_TO_STREAM(p, 5);              // TTL
+    UINT8_TO_STREAM(p, retrans_cnt);
+    UINT8_TO_STREAM(p, 4);              // Retransmit interval in 50 ms units
+    UINT8_TO_STREAM(p, 2);              // Reply timeout in seconds
+    return (uint32_t)(p - p_buffer);
+}
+
+void mesh_sim_status(uint16_t event, uint16_t src, void *p_data)
+{
+    wiced_bt_mesh_event_t *p_event;
+
+    if ((mesh_sim_client_callback[0] == NULL) ||
+        ((p_event = wiced_bt_mesh_create_event(0, MESH_COMPANY_ID_BT_SIG, WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT, MESH_SIM_CLIENT_ADDR, 0)) == NULL))
+        return;
+
+    p_event->src = src;
+    mesh_sim_stats.statuses++;
+    mesh_sim_client_callback[0](event, p_event, p_data);
+}
+
+void mesh_sim_lpn_sleep(uint32_t max_sleep_duration)
+{
+    if (wiced_bt_mesh_app_func_table.p_mesh_app_lpn_sleep != NULL)
+        wiced_bt_mesh_app_func_table.p_mesh_app_lpn_sleep(max_sleep_duration);
+}
+
+void mesh_sim_run(uint32_t duration)
+{
+    uint32_t end = mesh_sim_now + duration;
+    wiced_timer_t *p_timer;
+    wiced_timer_t *p_next_timer;
+    mesh_sim_delivery_t delivery;
+
+    for (;;)
+    {
+        p_next_timer = NULL;
+        for (p_timer = mesh_sim_timers; p_timer != NULL; p_timer = p_timer->p_next)
+        {
+            if ((p_next_timer == NULL) || ((int32_t)(p_timer->due_time - p_next_timer->due_time) < 0))
+                p_next_timer = p_timer;
+        }
+        // Messages go before timers due at the same time
+        if ((mesh_sim_heap_count != 0) && ((int32_t)(end - mesh_sim_heap[0].due_time) >= 0) &&
+            ((p_next_timer == NULL) || ((int32_t)(p_next_timer->due_time - mesh_sim_heap[0].due_time) >= 0)))
+        {
+            mesh_sim_pop(&delivery);
+            if ((int32_t)(delivery.due_time - mesh_sim_now) > 0)
+                mesh_sim_now = delivery.due_time;
+            mesh_sim_deliver(&delivery);
+            continue;
+        }
+        if ((p_next_timer == NULL) || ((int32_t)(end - p_next_timer->due_time) < 0))
+            break;
+
+        if ((int32_t)(p_next_timer->due_time - mesh_sim_now) > 0)
+            mesh_sim_now = p_next_timer->due_time;
+        mesh_sim_timer_remove(p_next_timer);
+        if ((p_next_timer->type == WICED_SECONDS_PERIODIC_TIMER) || (p_next_timer->type == WICED_MILLI_SECONDS_PERIODIC_TIMER))
+            wiced_start_timer(p_next_timer, p_next_timer->interval);
+        p_next_timer->cback(p_next_timer->cback_param);
+    }
+    mesh_sim_now = end;
+}
+
+uint32_t mesh_sim_pending(void)
+{
+    return mesh_sim_heap_count;
+}
+
+void mesh_sim_set_hci_callback(mesh_sim_hci_callback_t p_callback)
+{
+    mesh_sim_hci_callback = p_callback;
+}
+
+/*
+ * Send a Light CTL Client message to the servers at the destination. Each server which
+ * receives the message updates its state and, if a reply is expected, sends its status.
+ * The model retransmits an acknowledged message to a unicast address until the status
+ * arrives or retrans_cnt retransmissions were made. The event is returned to the client
+ * in the TX complete.
+ */
+wiced_result_t mesh_sim_send(wiced_bt_mesh_event_t *p_event, uint16_t reply_event, uint8_t length, uint16_t opcode, const void *p_params)
+{
+    mesh_sim_delivery_t delivery;
+    mesh_sim_server_t *p_server;
+    uint32_t interval;
+    uint32_t first;
+    uint32_t last;
+    uint16_t i;
+    uint8_t attempt;
+    wiced_bool_t is_unicast = (p_event->dst != 0) && ((p_event->dst & 0x8000) == 0);
+    wiced_bool_t received = WICED_FALSE;
+
+    // The model of an element which does not exist cannot send, this is an error of the client
+    if ((p_event->element_idx >= MESH_SIM_CLIENT_ELEMENTS) || (mesh_sim_client_callback[p_event->element_idx] == NULL))
+    {
+        printf("mesh sim: send from element %u without a Light CTL Client\n", p_event->element_idx);
+        abort();
+    }
+    mesh_sim_stats.mesh_messages++;
+    mesh_sim_stats.mesh_bytes += length;
+
+    memset(&delivery, 0, sizeof(delivery));
+    delivery.element_idx = p_event->element_idx;
+    delivery.app_key_idx = p_event->app_key_idx;
+    delivery.event       = reply_event;
+
+    interval = (p_event->retrans_time != 0) ? p_event->retrans_time * MESH_SIM_RETRANS_UNIT : MESH_SIM_RETRANS_DEFAULT;
+    first = mesh_sim_now + mesh_sim_config.reply_time;
+    last  = first;
+    for (i = 0; i < mesh_sim_config.num_servers; i++)
+    {
+        p_server = &mesh_sim_servers[i];
+        if (is_unicast && (p_event->dst != MESH_SIM_SERVER(i)))
+            continue;
+
+        // Retransmissions of the model are only made for an acknowledged message to a unicast address
+        for (attempt = 0; attempt <= ((is_unicast && p_event->reply) ? p_event->retrans_cnt : 0); attempt++)
+        {
+            mesh_sim_stats.transmissions++;
+            if ((mesh_sim_config.loss == 0) || ((mesh_sim_rand() % 100) >= mesh_sim_config.loss))
+                break;
+            mesh_sim_stats.lost++;
+        }
+        if (attempt > ((is_unicast && p_event->reply) ? p_event->retrans_cnt : 0))
+            continue;
+
+        received = WICED_TRUE;
+        mesh_sim_server_receive(p_server, opcode, p_params);
+        if (p_event->reply)
+        {
+            delivery.due_time = first + attempt * interval;
+            delivery.src      = MESH_SIM_SERVER(i);
+            mesh_sim_push(&delivery);
+            if ((int32_t)(delivery.due_time - last) > 0)
+                last = delivery.due_time;
+        }
+    }
+
+    // Acknowledged message to a unicast address completes when the status arrives or all
+    // retransmissions are made, others when they are sent
+    delivery.event   = WICED_BT_MESH_TX_COMPLETE;
+    delivery.src     = 0;
+    delivery.p_event = p_event;
+    if (is_unicast && p_event->reply)
+    {
+        delivery.tx_flag  = received ? TX_STATUS_ACK_RECEIVED : TX_STATUS_FAILED;
+        delivery.due_time = received ? last : mesh_sim_now + (p_event->retrans_cnt + 1) * interval;
+    }
+    else
+    {
+        delivery.tx_flag  = TX_STATUS_COMPLETED;
+        delivery.due_time = mesh_sim_now + mesh_sim_config.tx_time;
+    }
+    mesh_sim_push(&delivery);
+    return WICED_SUCCESS;
+}
+
+/*
+ * Simulated server processes a Light CTL message, transitions are immediate
+ */
+void mesh_sim_server_receive(mesh_sim_server_t *p_server, uint16_t opcode, const void *p_params)
+{
+    const wiced_bt_mesh_light_ctl_set_t *p_set;
+    const wiced_bt_mesh_light_ctl_temperature_set_t *p_temperature_set;
+    const wiced_bt_mesh_light_ctl_temperature_range_data_t *p_range;
+    const wiced_bt_mesh_light_ctl_default_data_t *p_default;
+
+    p_server->received++;
+    switch (opcode)
+    {
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET:
+        p_set = (const wiced_bt_mesh_light_ctl_set_t *)p_params;
+        p_server->present = p_set->target;
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET:
+        p_temperature_set = (const wiced_bt_mesh_light_ctl_temperature_set_t *)p_params;
+        p_server->present.temperature = p_temperature_set->target_temperature;
+        p_server->present.delta_uv    = p_temperature_set->target_delta_uv;
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET:
+        p_range = (const wiced_bt_mesh_light_ctl_temperature_range_data_t *)p_params;
+        p_server->range_min = p_range->min_level;
+        p_server->range_max = p_range->max_level;
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET:
+        p_default = (const wiced_bt_mesh_light_ctl_default_data_t *)p_params;
+        p_server->default_state = p_default->default_status;
+        break;
+    default:
+        break;
+    }
+    if (p_server->present.temperature < p_server->range_min)
+        p_server->present.temperature = p_server->range_min;
+    if (p_server->present.temperature > p_server->range_max)
+        p_server->present.temperature = p_server->range_max;
+}
+
+/*
+ * Pass a TX complete or the status of a server to the client
+ */
+void mesh_sim_deliver(mesh_sim_delivery_t *p_delivery)
+{
+    wiced_bt_mesh_event_t *p_event = p_delivery->p_event;
+    mesh_sim_server_t *p_server;
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    wiced_bt_mesh_light_ctl_default_data_t default_status;
+    wiced_bt_mesh_light_ctl_temperature_range_status_data_t range_status;
+    wiced_bt_mesh_light_ctl_client_callback_t *p_callback = mesh_sim_client_callback[p_delivery->element_idx];
+    void *p_data = NULL;
+
+    if (p_delivery->event == WICED_BT_MESH_TX_COMPLETE)
+    {
+        p_event->status.tx_flag = p_delivery->tx_flag;
+        mesh_sim_stats.tx_complete++;
+        if (p_callback != NULL)
+            p_callback(WICED_BT_MESH_TX_COMPLETE, p_event, NULL);
+        else
+            wiced_bt_mesh_release_event(p_event);
+        return;
+    }
+    if ((p_callback == NULL) || ((p_server = mesh_sim_server_find(p_delivery->src)) == NULL))
+        return;
+
+    switch (p_delivery->event)
+    {
+    case WICED_BT_MESH_LIGHT_CTL_STATUS:
+    case WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS:
+        memset(&status, 0, sizeof(status));
+        status.present = p_server->present;
+        status.target  = p_server->present;
+        p_data = &status;
+        break;
+    case WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS:
+        default_status.default_status = p_server->default_state;
+        p_data = &default_status;
+        break;
+    case WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS:
+        range_status.status    = 0;
+        range_status.min_level = p_server->range_min;
+        range_status.max_level = p_server->range_max;
+        p_data = &range_status;
+        break;
+    default:
+        return;
+    }
+    p_event = wiced_bt_mesh_create_event(p_delivery->element_idx, MESH_COMPANY_ID_BT_SIG, WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT,
+            MESH_SIM_CLIENT_ADDR + p_delivery->element_idx, p_delivery->app_key_idx);
+    if (p_event == NULL)
+        return;
+
+    p_event->src = p_delivery->src;
+    mesh_sim_stats.statuses++;
+    p_callback(p_delivery->event, p_event, p_data);
+}
+
+/*
+ * Add a delivery to the heap
+ */
+void mesh_sim_push(mesh_sim_delivery_t *p_delivery)
+{
+    mesh_sim_delivery_t tmp;
+    uint32_t i;
+    uint32_t parent;
+
+    if (mesh_sim_heap_count == mesh_sim_heap_size)
+    {
+        mesh_sim_heap_size = (mesh_sim_heap_size != 0) ? 2 * mesh_sim_heap_size : 256;
+        mesh_sim_heap = realloc(mesh_sim_heap, mesh_sim_heap_size * sizeof(mesh_sim_delivery_t));
+        if (mesh_sim_heap == NULL)
+        {
+            fprintf(stderr, "mesh sim: out of memory\n");
+            exit(1);
+        }
+    }
+    p_delivery->seq = mesh_sim_seq++;
+    i = mesh_sim_heap_count++;
+    mesh_sim_heap[i] = *p_delivery;
+    while (i != 0)
+    {
+        parent = (i - 1) / 2;
+        if (((int32_t)(mesh_sim_heap[parent].due_time - mesh_sim_heap[i].due_time) < 0) ||
+            ((mesh_sim_heap[parent].due_time == mesh_sim_heap[i].due_time) && (mesh_sim_heap[parent].seq < mesh_sim_heap[i].seq)))
+            break;
+        tmp = mesh_sim_heap[parent];
+        mesh_sim_heap[parent] = mesh_sim_heap[i];
+        mesh_sim_heap[i] = tmp;
+        i = parent;
+    }
+}
+
+/*
+ * Take the first delivery from the heap
+ */
+void mesh_sim_pop(mesh_sim_delivery_t *p_delivery)
+{
+    mesh_sim_delivery_t tmp;
+    uint32_t i = 0;
+    uint32_t child;
+
+    *p_delivery = mesh_sim_heap[0];
+    mesh_sim_heap[0] = mesh_sim_heap[--mesh_sim_heap_count];
+    for (;;)
+    {
+        child = 2 * i + 1;
+        if (child >= mesh_sim_heap_count)
+            break;
+        if ((child + 1 < mesh_sim_heap_count) &&
+            (((int32_t)(mesh_sim_heap[child + 1].due_time - mesh_sim_heap[child].due_time) < 0) ||
+             ((mesh_sim_heap[child + 1].due_time == mesh_sim_heap[child].due_time) && (mesh_sim_heap[child + 1].seq < mesh_sim_heap[child].seq))))
+            child++;
+        if (((int32_t)(mesh_sim_heap[i].due_time - mesh_sim_heap[child].due_time) < 0) ||
+            ((mesh_sim_heap[i].due_time == mesh_sim_heap[child].due_time) && (mesh_sim_heap[i].seq < mesh_sim_heap[child].seq)))
+            break;
+        tmp = mesh_sim_heap[child];
+        mesh_sim_heap[child] = mesh_sim_heap[i];
+        mesh_sim_heap[i] = tmp;
+        i = child;
+    }
+}
+
+/*
+ * Random numbers of the simulated mesh, kept apart from those of the application
+ */
+uint32_t mesh_sim_rand(void)
+{
+    mesh_sim_rand_state ^= mesh_sim_rand_state << 13;
+    mesh_sim_rand_state ^= mesh_sim_rand_state >> 17;
+    mesh_sim_rand_state ^= mesh_sim_rand_state << 5;
+    return mesh_sim_rand_state;
+}
+
+mesh_sim_server_t *mesh_sim_server_find(uint16_t addr)
+{
+    if ((addr < MESH_SIM_SERVER_ADDR) || (addr >= MESH_SIM_SERVER_ADDR + mesh_sim_config.num_servers))
+        return NULL;
+    return &mesh_sim_servers[addr - MESH_SIM_SERVER_ADDR];
+}
+
+/******************************************************
+ *          SDK functions used by the application
+ ******************************************************/
+void wiced_printf(const char *format, ...)
+{
+    va_list args;
+
+    if (!mesh_sim_config.trace)
+        return;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+uint32_t wiced_bt_mesh_core_get_tick_count(void)
+{
+    return mesh_sim_now;
+}
+
+uint32_t wiced_hal_rand_gen_num(void)
+{
+    mesh_sim_app_rand_state ^= mesh_sim_app_rand_state << 13;
+    mesh_sim_app_rand_state ^= mesh_sim_app_rand_state >> 17;
+    mesh_sim_app_rand_state ^= mesh_sim_app_rand_state << 5;
+    return mesh_sim_app_rand_state;
+}
+
+wiced_result_t wiced_init_timer(wiced_timer_t *p_timer, wiced_timer_callback_t TimerCb, TIMER_PARAM_TYPE cBackparam, wiced_timer_type_t type)
+{
+    memset(p_timer, 0, sizeof(*p_timer));
+    p_timer->cback       = TimerCb;
+    p_timer->cback_param = cBackparam;
+    p_timer->type        = type;
+    return WICED_SUCCESS;
+}
+
+wiced_result_t wiced_start_timer(wiced_timer_t *p_timer, uint32_t timeout)
+{
+    if (p_timer->cback == NULL)
+        return WICED_BADARG;
+
+    if (p_timer->in_use)
+        mesh_sim_timer_remove(p_timer);
+    p_timer->interval = timeout;
+    if ((p_timer->type == WICED_SECONDS_TIMER) || (p_timer->type == WICED_SECONDS_PERIODIC_TIMER))
+        timeout *= 1000;
+    p_timer->due_time = mesh_sim_now + timeout;
+    p_timer->in_use   = WICED_TRUE;
+    p_timer->p_next   = mesh_sim_timers;
+    mesh_sim_timers   = p_timer;
+    return WICED_SUCCESS;
+}
+
+wiced_result_t wiced_stop_timer(wiced_timer_t *p_timer)
+{
+    if (p_timer->in_use)
+        mesh_sim_timer_remove(p_timer);
+    return WICED_SUCCESS;
+}
+
+wiced_bool_t wiced_is_timer_in_use(wiced_timer_t *p_timer)
+{
+    return p_timer->in_use;
+}
+
+wiced_result_t wiced_deinit_timer(wiced_timer_t *p_timer)
+{
+    wiced_stop_timer(p_timer);
+    p_timer->cback = NULL;
+    return WICED_SUCCESS;
+}
+
+void mesh_sim_timer_remove(wiced_timer_t *p_timer)
+{
+    wiced_timer_t **pp_timer;
+
+    for (pp_timer = &mesh_sim_timers; *pp_timer != NULL; pp_timer = &(*pp_timer)->p_next)
+    {
+        if (*pp_timer == p_timer)
+        {
+            *pp_timer = p_timer->p_next;
+            break;
+        }
+    }
+    p_timer->in_use = WICED_FALSE;
+    p_timer->p_next = NULL;
+}
+
+uint16_t wiced_hal_write_nvram(uint16_t vs_id, uint16_t data_length, uint8_t *p_data, wiced_result_t *p_status)
+{
+    mesh_sim_nvram_t *p_item = mesh_sim_nvram_find(vs_id);
+
+    if ((p_item == NULL) && ((p_item = mesh_sim_nvram_find(0)) == NULL))
+    {
+        *p_status = WICED_OUT_OF_HEAP_SPACE;
+        return 0;
+    }
+    if ((data_length == 0) || (data_length > MESH_SIM_NVRAM_ITEM_LEN))
+    {
+        *p_status = WICED_BADARG;
+        return 0;
+    }
+    p_item->vs_id  = vs_id;
+    p_item->length = data_length;
+    memcpy(p_item->data, p_data, data_length);
+    mesh_sim_stats.nvram_writes++;
+    *p_status = WICED_SUCCESS;
+    return data_length;
+}
+
+uint16_t wiced_hal_read_nvram(uint16_t vs_id, uint16_t data_length, uint8_t *p_data, wiced_result_t *p_status)
+{
+    mesh_sim_nvram_t *p_item = mesh_sim_nvram_find(vs_id);
+
+    if (p_item == NULL)
+    {
+        *p_status = WICED_ERROR;
+        return 0;
+    }
+    if (data_length > p_item->length)
+        data_length = p_item->length;
+    memcpy(p_data, p_item->data, data_length);
+    *p_status = WICED_SUCCESS;
+    return data_length;
+}
+
+void wiced_hal_delete_nvram(uint16_t vs_id, wiced_result_t *p_status)
+{
+    mesh_sim_nvram_t *p_item = mesh_sim_nvram_find(vs_id);
+
+    if (p_item == NULL)
+    {
+        *p_status = WICED_ERROR;
+        return;
+    }
+    p_item->vs_id  = 0;
+    p_item->length = 0;
+    *p_status = WICED_SUCCESS;
+}
+
+/*
+ * NVRAM item with the id, the first free item for id 0
+ */
+mesh_sim_nvram_t *mesh_sim_nvram_find(uint16_t vs_id)
+{
+    uint8_t i;
+
+    for (i = 0; i < MESH_SIM_NVRAM_ITEMS; i++)
+    {
+        if ((vs_id == 0) ? (mesh_sim_nvram[i].length == 0) : ((mesh_sim_nvram[i].length != 0) && (mesh_sim_nvram[i].vs_id == vs_id)))
+            return &mesh_sim_nvram[i];
+    }
+    return NULL;
+}
+
+wiced_bt_mesh_event_t *wiced_bt_mesh_create_event(uint8_t element_idx, uint16_t company_id, uint16_t model_id, uint16_t dst, uint16_t app_key_idx)
+{
+    wiced_bt_mesh_event_t *p_event;
+    uint16_t i;
+
+    if (mesh_sim_event_free_count == 0)
+    {
+        mesh_sim_stats.event_failures++;
+        return NULL;
+    }
+    i = mesh_sim_event_free[--mesh_sim_event_free_count];
+    mesh_sim_event_used[i] = WICED_TRUE;
+    if (++mesh_sim_stats.events_in_use > mesh_sim_stats.events_high_water)
+        mesh_sim_stats.events_high_water = mesh_sim_stats.events_in_use;
+
+    p_event = &mesh_sim_events[i];
+    memset(p_event, 0, sizeof(*p_event));
+    p_event->element_idx = element_idx;
+    p_event->company_id  = company_id;
+    p_event->model_id    = model_id;
+    p_event->src         = MESH_SIM_CLIENT_ADDR + element_idx;
+    p_event->dst         = dst;
+    p_event->app_key_idx = app_key_idx;
+    p_event->ttl         = 5;
+    return p_event;
+}
+
+wiced_bt_mesh_event_t *wiced_bt_mesh_create_event_from_wiced_hci(uint16_t opcode, uint16_t company_id, uint16_t model_id, uint8_t **p_data, uint32_t *len)
+{
+    wiced_bt_mesh_event_t *p_event;
+    uint8_t *p = *p_data;
+    uint16_t dst;
+    uint16_t app_key_idx;
+    uint8_t element_idx;
+    uint8_t reply_timeout;
+
+    if (*len < MESH_SIM_HDR_LEN)
+        return NULL;
+
+    STREAM_TO_UINT16(dst, p);
+    STREAM_TO_UINT16(app_key_idx, p);
+    STREAM_TO_UINT8(element_idx, p);
+    if ((p_event = wiced_bt_mesh_create_event(element_idx, company_id, model_id, dst, app_key_idx)) == NULL)
+        return NULL;
+
+    p_event->opcode = opcode;
+    STREAM_TO_UINT8(p_event->reply, p);
+    STREAM_TO_UINT8(p_event->send_segmented, p);
+    STREAM_TO_UINT8(p_event->ttl, p);
+    STREAM_TO_UINT8(p_event->retrans_cnt, p);
+    STREAM_TO_UINT8(p_event->retrans_time, p);
+    STREAM_TO_UINT8(reply_timeout, p);
+    p_event->reply_timeout = reply_timeout * 1000;
+
+    *p_data = p;
+    *len   -= MESH_SIM_HDR_LEN;
+    return p_event;
+}
+
+void wiced_bt_mesh_release_event(wiced_bt_mesh_event_t *p_event)
+{
+    uint32_t i = (uint32_t)(p_event - mesh_sim_events);
+
+    if ((p_event < mesh_sim_events) || (i >= mesh_sim_config.num_events) || !mesh_sim_event_used[i])
+    {
+        fprintf(stderr, "mesh sim: release of event %p which is not in use\n", (void *)p_event);
+        abort();
+    }
+    mesh_sim_event_used[i] = WICED_FALSE;
+    mesh_sim_event_free[mesh_sim_event_free_count++] = (uint16_t)i;
+    mesh_sim_stats.events_in_use--;
+}
+
+wiced_bt_mesh_hci_event_t *wiced_bt_mesh_create_hci_event(wiced_bt_mesh_event_t *p_event)
+{
+    wiced_bt_mesh_hci_event_t *p_hci_event = (wiced_bt_mesh_hci_event_t *)mesh_sim_hci_event;
+
+    p_hci_event->src         = p_event->src;
+    p_hci_event->app_key_idx = p_event->app_key_idx;
+    p_hci_event->element_idx = p_event->element_idx;
+    return p_hci_event;
+}
+
+void wiced_bt_mesh_send_hci_tx_complete(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_event_t *p_event)
+{
+    uint8_t *p = p_hci_event->data;
+
+    UINT8_TO_STREAM(p, p_event->status.tx_flag);
+    UINT16_TO_STREAM(p, p_event->dst);
+    mesh_transport_send_data(HCI_CONTROL_MESH_EVENT_TX_COMPLETE, (uint8_t *)p_hci_event, (uint16_t)(p - (uint8_t *)p_hci_event));
+}
+
+wiced_result_t mesh_transport_send_data(uint16_t opcode, uint8_t *p_data, uint16_t length)
+{
+    mesh_sim_stats.hci_events++;
+    mesh_sim_stats.hci_bytes += length;
+    if (mesh_sim_hci_callback != NULL)
+        mesh_sim_hci_callback(opcode, p_data, length);
+    return WICED_SUCCESS;
+}
+
+void wiced_bt_mesh_set_raw_scan_response_data(uint8_t num_elem, wiced_bt_ble_advert_elem_t *p_data)
+{
+}
+
+void wiced_bt_mesh_model_light_ctl_client_init(uint8_t element_idx, wiced_bt_mesh_light_ctl_client_callback_t *p_callback, wiced_bool_t is_provisioned)
+{
+    if (element_idx < MESH_SIM_CLIENT_ELEMENTS)
+        mesh_sim_client_callback[element_idx] = p_callback;
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_get(wiced_bt_mesh_event_t *p_event)
+{
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_LEN_GET, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, NULL);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_set_t *p_set)
+{
+    uint8_t length = MESH_SIM_LEN_SET + (((p_set->transition_time | p_set->delay) != 0) ? MESH_SIM_LEN_TRANSITION : 0);
+
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_STATUS, length, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, p_set);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_get(wiced_bt_mesh_event_t *p_event)
+{
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS, MESH_SIM_LEN_GET, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET, NULL);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_temperature_set_t *p_set)
+{
+    uint8_t length = MESH_SIM_LEN_TEMPERATURE_SET + (((p_set->transition_time | p_set->delay) != 0) ? MESH_SIM_LEN_TRANSITION : 0);
+
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS, length, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET, p_set);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_range_get(wiced_bt_mesh_event_t *p_event)
+{
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS, MESH_SIM_LEN_GET, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET, NULL);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_temperature_range_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_temperature_range_data_t *p_set)
+{
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS, MESH_SIM_LEN_RANGE_SET, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET, p_set);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_default_get(wiced_bt_mesh_event_t *p_event)
+{
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS, MESH_SIM_LEN_GET, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET, NULL);
+}
+
+wiced_result_t wiced_bt_mesh_model_light_ctl_client_send_default_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_light_ctl_default_data_t *p_set)
+{
+    return mesh_sim_send(p_event, WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS, MESH_SIM_LEN_DEFAULT_SET, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET, p_set);
+}
@@ -0,0 +1,151 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Simulated mesh for host builds of the Light CTL Client. The simulator provides the SDK
+ * functions used by mesh_light_ctl_client.c: a clock which only moves when the harness runs
+ * it, timers on that clock, the pool of mesh events, NVRAM in memory, and Light CTL Servers
+ * which answer the messages sent by the client. Events sent by the client to the host are
+ * counted and passed to an optional callback.
+ */
+#ifndef MESH_SIM_H
+#define MESH_SIM_H
+
+#include "wiced_bt_mesh_models.h"
+#include "wiced_bt_mesh_app.h"
+
+#define MESH_SIM_CLIENT_ADDR        0x0001      // Address of the first client element, others follow
+#define MESH_SIM_SERVER_ADDR        0x0100      // Address of the first simulated server, others follow
+#define MESH_SIM_GROUP_ADDR         0xC000      // Group subscribed by all servers, also used for publications
+#define MESH_SIM_MAX_SERVERS        1024
+#define MESH_SIM_MAX_EVENTS         256
+#define MESH_SIM_HDR_LEN            11          // Mesh header of a command, see wiced_bt_mesh_create_event_from_wiced_hci
+
+typedef struct
+{
+    uint16_t     num_servers;                   // Light CTL Servers at MESH_SIM_SERVER_ADDR and following addresses
+    uint16_t     num_events;                    // Mesh events shared by the client and the mesh library
+    uint16_t     tx_time;                       // Time in ms from a send to its TX complete
+    uint16_t     reply_time;                    // Time in ms from a send to the status of a server
+    uint8_t      loss;                          // Percentage of transmissions lost on the way to a server
+    uint32_t     seed;                          // Seed of the random numbers of the client and of the mesh
+    wiced_bool_t is_provisioned;
+    wiced_bool_t trace;                         // Print the traces of the client
+} mesh_sim_config_t;
+
+typedef struct
+{
+    uint64_t commands;                          // HCI commands passed to the client
+    uint64_t command_bytes;
+    uint64_t hci_events;                        // Events sent by the client to the host
+    uint64_t hci_bytes;
+    uint64_t mesh_messages;                     // Messages sent by the client over the mesh
+    uint64_t mesh_bytes;                        // Access payload of the messages, opcode included
+    uint64_t transmissions;                     // Messages and retransmissions by the model
+    uint64_t lost;                              // Transmissions which did not reach a server
+    uint64_t statuses;                          // Statuses passed to the client
+    uint64_t tx_complete;                       // TX complete events passed to the client
+    uint64_t event_failures;                    // Event requests which found the pool empty
+    uint32_t events_in_use;
+    uint32_t events_high_water;
+    uint64_t nvram_writes;
+} mesh_sim_stats_t;
+
+// State of a simulated Light CTL Server
+typedef struct
+{
+    wiced_bt_mesh_light_ctl_data_t present;
+    wiced_bt_mesh_light_ctl_data_t default_state;
+    uint16_t range_min;
+    uint16_t range_max;
+    uint32_t received;                          // Messages received by the server
+} mesh_sim_server_t;
+
+typedef void (*mesh_sim_hci_callback_t)(uint16_t opcode, const uint8_t *p_data, uint16_t length);
+
+extern mesh_sim_stats_t  mesh_sim_stats;
+extern mesh_sim_server_t mesh_sim_servers[MESH_SIM_MAX_SERVERS];
+
+/*
+ * Default configuration: 64 servers, 48 events, 2 ms to the TX complete, 4 ms to the status
+ */
+void mesh_sim_config_default(mesh_sim_config_t *p_config);
+
+/*
+ * Reset the simulator and initialize the application. The application keeps its state in
+ * static variables, so this is called once per process.
+ */
+void mesh_sim_init(const mesh_sim_config_t *p_config);
+
+/*
+ * Pass an HCI command to the application as the mesh application library does
+ */
+uint32_t mesh_sim_command(uint16_t opcode, const uint8_t *p_data, uint32_t length);
+
+/*
+ * Write the mesh header of a command to p_buffer and return the length written
+ */
+uint32_t mesh_sim_command_hdr(uint8_t *p_buffer, uint16_t dst, uint8_t element_idx, wiced_bool_t reply, uint8_t retrans_cnt);
+
+/*
+ * Pass a status from a server straight to the Light CTL Client callback of element 0
+ */
+void mesh_sim_status(uint16_t event, uint16_t src, void *p_data);
+
+/*
+ * Tell the application the mesh core is going to sleep, as a low power node does after a friend poll
+ */
+void mesh_sim_lpn_sleep(uint32_t max_sleep_duration);
+
+/*
+ * Advance the simulated clock by duration ms, delivering messages and running timers which are due
+ */
+void mesh_sim_run(uint32_t duration);
+
+/*
+ * Number of deliveries waiting on the simulated mesh
+ */
+uint32_t mesh_sim_pending(void);
+
+/*
+ * Events sent by the client to the host are passed to p_callback, NULL to only count them
+ */
+void mesh_sim_set_hci_callback(mesh_sim_hci_callback_t p_callback);
+
+/*
+ * Address of a simulated server, index from 0
+ */
+#define MESH_SIM_SERVER(index)      ((uint16_t)(MESH_SIM_SERVER_ADDR + (index)))
+
+#endif // MESH_SIM_H
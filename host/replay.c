@@ -0,0 +1,202 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Replay of a capture of AIROC HCI traffic on the simulated mesh. The capture is recorded by a
+ * client built with HCI_CAPTURE=1 and read by the host with HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ.
+ * The file holds the capture bytes of the HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA parts in offset
+ * order, without their 6 byte headers. The captured commands are passed to the client of the host
+ * build at the captured speed, N times faster or as fast as possible, and the simulated Light CTL
+ * Servers answer them, so that a load seen on a network can be reproduced without sending anything
+ * to real lights.
+ *
+ * Usage: replay capture_file [speed [servers [loss]]]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh_sim.h"
+#include "mesh_light_ctl_hci.h"
+
+/******************************************************
+ *          Constants
+ ******************************************************/
+#define REPLAY_MAX_CAPTURE      0x10000     // Capture length is sent in 2 bytes
+#define REPLAY_BURST            8           // Commands replayed in one ms at maximum speed
+
+/******************************************************
+ *          Structures
+ ******************************************************/
+typedef struct
+{
+    uint32_t commands;                      // Commands passed to the client
+    uint32_t skipped;                       // Capture commands and truncated records
+    uint32_t refused;                       // Commands not accepted, or tracked requests completed without room in the request table
+    uint32_t captured_events;               // Events to the host in the capture
+    uint32_t events;                        // Events to the host during the replay
+    uint32_t captured_ms;
+    uint32_t elapsed_ms;                    // Simulated time of the replay
+} replay_result_t;
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static void replay_run(const uint8_t *p_capture, uint32_t length, uint32_t speed, replay_result_t *p_result);
+static void replay_hci_event(uint16_t opcode, const uint8_t *p_data, uint16_t length);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+static uint8_t replay_capture[REPLAY_MAX_CAPTURE];
+static uint32_t replay_events = 0;
+static uint32_t replay_refused = 0;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int main(int argc, char *argv[])
+{
+    mesh_sim_config_t config;
+    replay_result_t result;
+    uint32_t length;
+    uint32_t speed;
+    FILE *p_file;
+
+    if (argc < 2)
+    {
+        printf("usage: %s capture_file [speed [servers [loss]]]\n", argv[0]);
+        return 2;
+    }
+    if ((p_file = fopen(argv[1], "rb")) == NULL)
+    {
+        perror(argv[1]);
+        return 2;
+    }
+    length = (uint32_t)fread(replay_capture, 1, sizeof(replay_capture), p_file);
+    fclose(p_file);
+
+    speed = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1;
+    mesh_sim_config_default(&config);
+    if (argc > 3)
+        config.num_servers = (uint16_t)strtoul(argv[3], NULL, 0);
+    if (argc > 4)
+        config.loss = (uint8_t)strtoul(argv[4], NULL, 0);
+    mesh_sim_init(&config);
+    mesh_sim_set_hci_callback(replay_hci_event);
+
+    replay_run(replay_capture, length, speed, &result);
+
+    printf("commands:%u skipped:%u refused:%u\n", result.commands, result.skipped, result.refused);
+    printf("captured ms:%u events:%u\n", result.captured_ms, result.captured_events);
+    printf("replayed ms:%u events:%u\n", result.elapsed_ms, result.events);
+    printf("mesh messages:%llu transmissions:%llu lost:%llu\n", (unsigned long long)mesh_sim_stats.mesh_messages,
+            (unsigned long long)mesh_sim_stats.transmissions, (unsigned long long)mesh_sim_stats.lost);
+    printf("events high water:%u event failures:%llu\n", mesh_sim_stats.events_high_water, (unsigned long long)mesh_sim_stats.event_failures);
+    return (mesh_sim_stats.events_in_use == 0) ? 0 : 1;
+}
+
+/*
+ * Pass the captured commands to the client, moving the simulated clock by the captured time
+ * divided by the speed, or by 1 ms every REPLAY_BURST commands for speed 0. Commands which
+ * control the capture are not replayed.
+ */
+void replay_run(const uint8_t *p_capture, uint32_t length, uint32_t speed, replay_result_t *p_result)
+{
+    const uint8_t *p = p_capture;
+    const uint8_t *p_end = p_capture + length;
+    uint8_t type;
+    uint16_t delta, opcode, len;
+    uint32_t start = wiced_bt_mesh_core_get_tick_count();
+    uint32_t due, elapsed;
+    uint32_t burst = 0;
+
+    memset(p_result, 0, sizeof(*p_result));
+    while (p_end - p >= MESH_LIGHT_CTL_CAPTURE_HDR_LEN)
+    {
+        STREAM_TO_UINT8(type, p);
+        STREAM_TO_UINT16(delta, p);
+        STREAM_TO_UINT16(opcode, p);
+        STREAM_TO_UINT16(len, p);
+        p_result->captured_ms += delta;
+
+        if (type == MESH_LIGHT_CTL_CAPTURE_EVENT)
+        {
+            p_result->captured_events++;
+            continue;
+        }
+        if (p_end - p < len)
+        {
+            p_result->skipped++;
+            break;
+        }
+        p += len;
+        if (type != MESH_LIGHT_CTL_CAPTURE_COMMAND)
+            continue;
+        if ((opcode == HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG) || (opcode == HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ))
+        {
+            p_result->skipped++;
+            continue;
+        }
+
+        elapsed = wiced_bt_mesh_core_get_tick_count() - start;
+        if (speed != 0)
+        {
+            due = p_result->captured_ms / speed;
+            if (due > elapsed)
+                mesh_sim_run(due - elapsed);
+        }
+        else if (++burst == REPLAY_BURST)
+        {
+            mesh_sim_run(1);
+            burst = 0;
+        }
+        mesh_sim_command(opcode, p - len, len);
+        p_result->commands++;
+    }
+    p_result->elapsed_ms = wiced_bt_mesh_core_get_tick_count() - start;
+
+    // Let everything sent complete
+    mesh_sim_run(60000);
+    p_result->events  = replay_events;
+    p_result->refused = replay_refused;
+}
+
+void replay_hci_event(uint16_t opcode, const uint8_t *p_data, uint16_t length)
+{
+    replay_events++;
+    if (opcode == HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)
+        replay_refused++;
+    else if ((opcode == HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE) && (length > 6) && (p_data[6] == MESH_LIGHT_CTL_CLIENT_RESULT_NO_RESOURCES))
+        replay_refused++;
+}
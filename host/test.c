@@ -0,0 +1,189 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Test runner of the host build, see test.h
+ */
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test.h"
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static int test_run(const test_case_t *p_case, void (*p_setup)(const char *p_name));
+static void test_hci_event(uint16_t opcode, const uint8_t *p_data, uint16_t length);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+test_event_t test_events[TEST_MAX_EVENTS];
+uint32_t     test_num_events = 0;
+
+mesh_sim_config_t test_config;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int test_main(const test_case_t *p_cases, uint32_t num_cases, void (*p_setup)(const char *p_name), int argc, char *argv[])
+{
+    uint32_t i;
+    int j;
+    uint32_t failed = 0;
+    uint32_t run = 0;
+
+    for (i = 0; i < num_cases; i++)
+    {
+        for (j = 1; j < argc; j++)
+        {
+            if (strcmp(argv[j], p_cases[i].p_name) == 0)
+                break;
+        }
+        if ((argc > 1) && (j == argc))
+            continue;
+
+        run++;
+        if (test_run(&p_cases[i], p_setup) != 0)
+        {
+            printf("FAIL %s\n", p_cases[i].p_name);
+            failed++;
+        }
+    }
+    printf("%u tests, %u failed\n", run, failed);
+    return (failed == 0) ? 0 : 1;
+}
+
+/*
+ * Run a test in a child process. After the test the mesh is run until everything sent is
+ * complete, and every mesh event must have been released.
+ */
+int test_run(const test_case_t *p_case, void (*p_setup)(const char *p_name))
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0)
+        return -1;
+    if (pid == 0)
+    {
+        mesh_sim_config_default(&test_config);
+        if (p_setup != NULL)
+            p_setup(p_case->p_name);
+        mesh_sim_init(&test_config);
+        mesh_sim_set_hci_callback(test_hci_event);
+        test_clear_events();
+
+        p_case->p_test();
+
+        mesh_sim_run(60000);
+        TEST_ASSERT_EQ(mesh_sim_pending(), 0);
+        TEST_ASSERT_EQ(mesh_sim_stats.events_in_use, 0);
+        fflush(stdout);
+        _exit(0);
+    }
+    if (waitpid(pid, &status, 0) != pid)
+        return -1;
+    return (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? 0 : 1;
+}
+
+void test_command(uint16_t opcode, uint16_t dst, const uint8_t *p_data, uint32_t length)
+{
+    test_command_reply(opcode, dst, WICED_TRUE, p_data, length);
+}
+
+void test_command_reply(uint16_t opcode, uint16_t dst, wiced_bool_t reply, const uint8_t *p_data, uint32_t length)
+{
+    uint8_t buffer[512];
+    uint32_t hdr_len = mesh_sim_command_hdr(buffer, dst, 0, reply, 0);
+
+    TEST_ASSERT(hdr_len + length <= sizeof(buffer));
+    memcpy(&buffer[hdr_len], p_data, length);
+    mesh_sim_command(opcode, buffer, hdr_len + length);
+}
+
+void test_config_command(uint16_t opcode, const uint8_t *p_data, uint32_t length)
+{
+    mesh_sim_command(opcode, p_data, length);
+}
+
+void test_clear_events(void)
+{
+    test_num_events = 0;
+}
+
+uint32_t test_count_events(uint16_t opcode)
+{
+    uint32_t i;
+    uint32_t count = 0;
+
+    for (i = 0; i < test_num_events; i++)
+    {
+        if (test_events[i].opcode == opcode)
+            count++;
+    }
+    return count;
+}
+
+const test_event_t *test_last_event(uint16_t opcode)
+{
+    uint32_t i;
+
+    for (i = test_num_events; i > 0; i--)
+    {
+        if (test_events[i - 1].opcode == opcode)
+            return &test_events[i - 1];
+    }
+    return NULL;
+}
+
+/*
+ * Record an event sent to the host, the oldest events are dropped when the record is full
+ */
+void test_hci_event(uint16_t opcode, const uint8_t *p_data, uint16_t length)
+{
+    test_event_t *p_event;
+
+    if (test_num_events == TEST_MAX_EVENTS)
+    {
+        memmove(&test_events[0], &test_events[1], sizeof(test_events) - sizeof(test_events[0]));
+        test_num_events--;
+    }
+    p_event = &test_events[test_num_events++];
+    p_event->opcode = opcode;
+    p_event->length = (length < TEST_MAX_EVENT_LEN) ? length : TEST_MAX_EVENT_LEN;
+    memcpy(p_event->data, p_data, p_event->length);
+}
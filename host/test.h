@@ -0,0 +1,109 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Tests of the host build. Each test runs in its own process on a freshly initialized
+ * simulated mesh, because the application keeps its state in static variables. Events sent
+ * by the application to the host are recorded and can be looked up by the test.
+ */
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mesh_sim.h"
+
+#define TEST_MAX_EVENTS         256
+#define TEST_MAX_EVENT_LEN      256
+
+// Event sent by the application to the host
+typedef struct
+{
+    uint16_t opcode;
+    uint16_t length;
+    uint8_t  data[TEST_MAX_EVENT_LEN];
+} test_event_t;
+
+typedef struct
+{
+    const char *p_name;
+    void (*p_test)(void);
+} test_case_t;
+
+#define TEST_CASE(name)         { #name, name }
+
+#define TEST_ASSERT(cond) \
+    do { if (!(cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); exit(1); } } while (0)
+
+#define TEST_ASSERT_EQ(a, b) \
+    do { long long _a = (long long)(a), _b = (long long)(b); \
+         if (_a != _b) { printf("%s:%d: %s == %s, %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); exit(1); } } while (0)
+
+extern test_event_t test_events[TEST_MAX_EVENTS];
+extern uint32_t     test_num_events;
+
+/*
+ * Configuration used to initialize the simulated mesh. A test can change it in its setup function.
+ */
+extern mesh_sim_config_t test_config;
+
+/*
+ * Run the tests named on the command line, all tests if none is named. Returns the exit code.
+ * p_setup, if not NULL, is called before the simulated mesh is initialized.
+ */
+int test_main(const test_case_t *p_cases, uint32_t num_cases, void (*p_setup)(const char *p_name), int argc, char *argv[]);
+
+/*
+ * Pass a command with the mesh header to the application, test_command expects a status
+ */
+void test_command(uint16_t opcode, uint16_t dst, const uint8_t *p_data, uint32_t length);
+void test_command_reply(uint16_t opcode, uint16_t dst, wiced_bool_t reply, const uint8_t *p_data, uint32_t length);
+
+/*
+ * Pass a command without a mesh header to the application
+ */
+void test_config_command(uint16_t opcode, const uint8_t *p_data, uint32_t length);
+
+/*
+ * Forget the recorded events
+ */
+void test_clear_events(void);
+
+/*
+ * Number of recorded events with the opcode, and the last one of them or NULL
+ */
+uint32_t test_count_events(uint16_t opcode);
+const test_event_t *test_last_event(uint16_t opcode);
+
+#endif // TEST_H
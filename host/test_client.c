@@ -0,0 +1,1151 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Tests of the Light CTL Client on the simulated mesh.
+ *
+ * Usage: test_client [test names]
+ */
+#include <string.h>
+#include "test.h"
+#include "wiced_hal_nvram.h"
+#include "mesh_light_ctl_codec.h"
+#include "mesh_light_ctl_hci.h"
+
+/******************************************************
+ *          Constants
+ ******************************************************/
+#define TEST_HCI_EVENT_HDR_LEN      5       // Source, application key index and element index before the status
+#define TEST_SETTLE_TIME            2000    // Time in ms after which a message held by a low power node has been answered
+
+// Layout of HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LATENCY_HISTOGRAM
+#define TEST_LATENCY_STAGE_QUEUE    0
+#define TEST_LATENCY_STAGE_TX       1
+#define TEST_LATENCY_STAGE_RESPONSE 2
+#define TEST_LATENCY_STAGES         3
+#define TEST_LATENCY_BUCKETS        16
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static void test_setup(const char *p_name);
+static void test_set(uint16_t dst, uint16_t lightness, uint16_t temperature);
+static void test_set_unacked(uint16_t dst, uint16_t lightness, uint16_t temperature);
+static void test_temperature_set(uint16_t dst, uint16_t temperature);
+static void test_request_config(uint8_t window, uint16_t timeout, uint8_t retries);
+static uint32_t test_latency(uint16_t opcode, uint8_t stage, int bucket);
+static uint32_t test_curve(uint8_t *p_buffer, uint16_t minute, const uint16_t *p_keyframes, uint8_t num);
+static void test_get(uint16_t dst, uint8_t message);
+static void test_get_cached(uint16_t dst, uint8_t message, uint16_t max_age);
+static wiced_bool_t test_decode_cached_status(const test_event_t *p_event, uint8_t message, uint16_t *p_src, uint32_t *p_age, void *p_status);
+static wiced_bool_t test_decode_status(const test_event_t *p_event, uint8_t message, uint16_t *p_src, void *p_status);
+
+static void test_set_reaches_server(void);
+static void test_get_reports_status(void);
+static void test_cache_saved_in_application_nvram(void);
+static void test_tx_complete_matches_event(void);
+static void test_latency_bucket_boundaries(void);
+static void test_no_entry_without_window(void);
+static void test_client_retries_without_model_retransmissions(void);
+static void test_model_retransmissions_without_client_retries(void);
+static void test_element_any_leaves_command(void);
+static void test_coalesce_keeps_order(void);
+static void test_short_config_command_status(void);
+static void test_set_multi_bad_length(void);
+static void test_sweep_reports_each_server(void);
+static void test_sweep_bad_command(void);
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+static void test_lpn_sleep_sends_held(void);
+#endif
+#if !defined(LOW_POWER_NODE) || (LOW_POWER_NODE == 0)
+static void test_stagger_spreads_group_sets(void);
+#endif
+static void test_range_check_keeps_cache(void);
+static void test_range_fetched_for_new_server(void);
+static void test_curve_steps_through_keyframes(void);
+static void test_curve_refused_keeps_curve(void);
+static void test_cached_status_per_kind(void);
+static void test_filter_forwards_get_reply(void);
+static void test_credits_follow_free_events(void);
+static void test_status_batch_before_tx_complete(void);
+static void test_pool_stats_count_statuses(void);
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+static void test_capture_read_pages(void);
+#endif
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+extern wiced_bt_mesh_app_func_table_t wiced_bt_mesh_app_func_table;
+
+static const test_case_t test_cases[] =
+{
+    TEST_CASE(test_set_reaches_server),
+    TEST_CASE(test_get_reports_status),
+    TEST_CASE(test_cache_saved_in_application_nvram),
+    TEST_CASE(test_tx_complete_matches_event),
+    TEST_CASE(test_latency_bucket_boundaries),
+    TEST_CASE(test_no_entry_without_window),
+    TEST_CASE(test_client_retries_without_model_retransmissions),
+    TEST_CASE(test_model_retransmissions_without_client_retries),
+    TEST_CASE(test_element_any_leaves_command),
+    TEST_CASE(test_coalesce_keeps_order),
+    TEST_CASE(test_short_config_command_status),
+    TEST_CASE(test_set_multi_bad_length),
+    TEST_CASE(test_sweep_reports_each_server),
+    TEST_CASE(test_sweep_bad_command),
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    TEST_CASE(test_lpn_sleep_sends_held),
+#endif
+#if !defined(LOW_POWER_NODE) || (LOW_POWER_NODE == 0)
+    TEST_CASE(test_stagger_spreads_group_sets),
+#endif
+    TEST_CASE(test_range_check_keeps_cache),
+    TEST_CASE(test_range_fetched_for_new_server),
+    TEST_CASE(test_curve_steps_through_keyframes),
+    TEST_CASE(test_curve_refused_keeps_curve),
+    TEST_CASE(test_cached_status_per_kind),
+    TEST_CASE(test_filter_forwards_get_reply),
+    TEST_CASE(test_credits_follow_free_events),
+    TEST_CASE(test_status_batch_before_tx_complete),
+    TEST_CASE(test_pool_stats_count_statuses),
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+    TEST_CASE(test_capture_read_pages),
+#endif
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int main(int argc, char *argv[])
+{
+    return test_main(test_cases, sizeof(test_cases) / sizeof(test_cases[0]), test_setup, argc, argv);
+}
+
+/*
+ * Change the simulated mesh for the tests which need it
+ */
+void test_setup(const char *p_name)
+{
+    if (strcmp(p_name, "test_tx_complete_matches_event") == 0)
+    {
+        test_config.tx_time    = 1;
+        test_config.reply_time = 40;
+    }
+    if (strcmp(p_name, "test_credits_follow_free_events") == 0)
+        test_config.num_events = 24;    // As many mesh events as the client budget
+    if (strcmp(p_name, "test_latency_bucket_boundaries") == 0)
+    {
+        test_config.tx_time    = 4;
+        test_config.reply_time = 127;
+    }
+    if ((strcmp(p_name, "test_client_retries_without_model_retransmissions") == 0) ||
+        (strcmp(p_name, "test_model_retransmissions_without_client_retries") == 0))
+    {
+        test_config.loss = 100;
+    }
+}
+
+/*
+ * Send Light CTL Set with the lightness and temperature, and no transition
+ */
+void test_set(uint16_t dst, uint16_t lightness, uint16_t temperature)
+{
+    wiced_bt_mesh_light_ctl_set_t set;
+    uint8_t buffer[32];
+    uint16_t length;
+
+    memset(&set, 0, sizeof(set));
+    set.target.lightness   = lightness;
+    set.target.temperature = temperature;
+    length = mesh_light_ctl_codec_encode(&mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_SET], &set, buffer, sizeof(buffer));
+    TEST_ASSERT(length != MESH_LIGHT_CTL_CODEC_ERROR);
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, dst, buffer, length);
+}
+
+/*
+ * Send Light CTL Temperature Set with the temperature, and no transition
+ */
+void test_temperature_set(uint16_t dst, uint16_t temperature)
+{
+    wiced_bt_mesh_light_ctl_temperature_set_t set;
+    uint8_t buffer[32];
+    uint16_t length;
+
+    memset(&set, 0, sizeof(set));
+    set.target_temperature = temperature;
+    length = mesh_light_ctl_codec_encode(&mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET], &set, buffer, sizeof(buffer));
+    TEST_ASSERT(length != MESH_LIGHT_CTL_CODEC_ERROR);
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET, dst, buffer, length);
+}
+
+/*
+ * Send Light CTL Set which does not expect a status
+ */
+void test_set_unacked(uint16_t dst, uint16_t lightness, uint16_t temperature)
+{
+    wiced_bt_mesh_light_ctl_set_t set;
+    uint8_t buffer[32];
+    uint16_t length;
+
+    memset(&set, 0, sizeof(set));
+    set.target.lightness   = lightness;
+    set.target.temperature = temperature;
+    length = mesh_light_ctl_codec_encode(&mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_SET], &set, buffer, sizeof(buffer));
+    TEST_ASSERT(length != MESH_LIGHT_CTL_CODEC_ERROR);
+    test_command_reply(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, dst, WICED_FALSE, buffer, length);
+}
+
+/*
+ * Configure request tracking
+ */
+void test_request_config(uint8_t window, uint16_t timeout, uint8_t retries)
+{
+    uint8_t config[4] = { window, (uint8_t)timeout, (uint8_t)(timeout >> 8), retries };
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG, config, sizeof(config));
+}
+
+/*
+ * Read the latency histograms and return the count of a bucket of a command, for all destination
+ * classes. Bucket -1 returns the count of all buckets.
+ */
+uint32_t test_latency(uint16_t opcode, uint8_t stage, int bucket)
+{
+    const test_event_t *p_event;
+    const uint8_t *p;
+    uint32_t count = 0;
+    uint32_t i;
+    int b;
+
+    test_clear_events();
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LATENCY_GET, NULL, 0);
+    for (i = 0; i < test_num_events; i++)
+    {
+        p_event = &test_events[i];
+        if ((p_event->opcode != HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LATENCY_HISTOGRAM) || ((p_event->data[0] | (p_event->data[1] << 8)) != opcode))
+            continue;
+        TEST_ASSERT_EQ(p_event->length, 3 + TEST_LATENCY_STAGES * TEST_LATENCY_BUCKETS * 2);
+        for (b = 0; b < TEST_LATENCY_BUCKETS; b++)
+        {
+            p = &p_event->data[3 + (stage * TEST_LATENCY_BUCKETS + b) * 2];
+            if ((bucket < 0) || (bucket == b))
+                count += p[0] | (p[1] << 8);
+        }
+    }
+    return count;
+}
+
+/*
+ * Write curve data for the minute of the day and keyframes of minute, lightness and temperature,
+ * without tolerances, and return its length
+ */
+uint32_t test_curve(uint8_t *p_buffer, uint16_t minute, const uint16_t *p_keyframes, uint8_t num)
+{
+    uint8_t *p = p_buffer;
+    uint32_t i;
+
+    UINT16_TO_STREAM(p, minute);
+    UINT16_TO_STREAM(p, 0);
+    UINT16_TO_STREAM(p, 0);
+    UINT8_TO_STREAM(p, num);
+    for (i = 0; i < 3 * (uint32_t)num; i++)
+        UINT16_TO_STREAM(p, p_keyframes[i]);
+    return (uint32_t)(p - p_buffer);
+}
+
+/*
+ * Send one of the get commands without a maximum age
+ */
+void test_get(uint16_t dst, uint8_t message)
+{
+    test_command(mesh_light_ctl_codec_messages[message].opcode, dst, NULL, 0);
+}
+
+/*
+ * Send a get which accepts a status from the client cache up to max_age ms old
+ */
+void test_get_cached(uint16_t dst, uint8_t message, uint16_t max_age)
+{
+    mesh_light_ctl_codec_get_t get;
+    uint8_t buffer[8];
+    uint16_t length;
+
+    get.max_age = max_age;
+    length = mesh_light_ctl_codec_encode(&mesh_light_ctl_codec_messages[message], &get, buffer, sizeof(buffer));
+    TEST_ASSERT(length != MESH_LIGHT_CTL_CODEC_ERROR);
+    test_command(mesh_light_ctl_codec_messages[message].opcode, dst, buffer, length);
+}
+
+/*
+ * Decode a status sent to the host from the client cache
+ */
+wiced_bool_t test_decode_cached_status(const test_event_t *p_event, uint8_t message, uint16_t *p_src, uint32_t *p_age, void *p_status)
+{
+    const uint8_t *p;
+
+    if ((p_event == NULL) || (p_event->length < 8))
+        return WICED_FALSE;
+
+    p = p_event->data;
+    STREAM_TO_UINT16(*p_src, p);
+    STREAM_TO_UINT32(*p_age, p);
+    if ((p[0] | (p[1] << 8)) != mesh_light_ctl_codec_messages[message].opcode)
+        return WICED_FALSE;
+    return mesh_light_ctl_codec_decode(&mesh_light_ctl_codec_messages[message], p + 2, p_event->length - 8U, p_status) != MESH_LIGHT_CTL_CODEC_ERROR;
+}
+
+/*
+ * Decode a status event sent to the host
+ */
+wiced_bool_t test_decode_status(const test_event_t *p_event, uint8_t message, uint16_t *p_src, void *p_status)
+{
+    if ((p_event == NULL) || (p_event->length < TEST_HCI_EVENT_HDR_LEN))
+        return WICED_FALSE;
+
+    *p_src = (uint16_t)(p_event->data[0] | (p_event->data[1] << 8));
+    return mesh_light_ctl_codec_decode(&mesh_light_ctl_codec_messages[message], &p_event->data[TEST_HCI_EVENT_HDR_LEN],
+            p_event->length - TEST_HCI_EVENT_HDR_LEN, p_status) != MESH_LIGHT_CTL_CODEC_ERROR;
+}
+
+void test_set_reaches_server(void)
+{
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    uint16_t src;
+
+    test_set(MESH_SIM_SERVER(3), 1000, 3000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT_EQ(mesh_sim_servers[3].present.lightness, 1000);
+    TEST_ASSERT_EQ(mesh_sim_servers[3].present.temperature, 3000);
+    TEST_ASSERT(test_decode_status(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), MESH_LIGHT_CTL_CODEC_STATUS, &src, &status));
+    TEST_ASSERT_EQ(src, MESH_SIM_SERVER(3));
+    TEST_ASSERT_EQ(status.present.lightness, 1000);
+    TEST_ASSERT_EQ(status.present.temperature, 3000);
+}
+
+void test_get_reports_status(void)
+{
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    uint16_t src;
+
+    mesh_sim_servers[5].present.temperature = 4000;
+    test_get(MESH_SIM_SERVER(5), MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET);
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT_EQ(mesh_sim_servers[5].received, 1);
+    TEST_ASSERT(test_decode_status(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_STATUS), MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS, &src, &status));
+    TEST_ASSERT_EQ(src, MESH_SIM_SERVER(5));
+    TEST_ASSERT_EQ(status.present.temperature, 4000);
+}
+
+/*
+ * Cache is saved at the start of the application NVRAM range, away from the items of the mesh core
+ */
+void test_cache_saved_in_application_nvram(void)
+{
+    uint8_t buffer[512];
+    wiced_result_t result;
+
+    test_get(MESH_SIM_SERVER(1), MESH_LIGHT_CTL_CODEC_GET);
+    mesh_sim_run(40000);
+
+    TEST_ASSERT(wiced_hal_read_nvram(WICED_NVRAM_VSID_START, sizeof(buffer), buffer, &result) != 0);
+    TEST_ASSERT_EQ(result, WICED_SUCCESS);
+}
+
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+/*
+ * Each capture read sends one part, from the offset in the command, and a read at the end of
+ * the capture sends a part without data
+ */
+void test_capture_read_pages(void)
+{
+    uint8_t capture[4096];
+    uint8_t command[2];
+    uint8_t enable = 1;
+    uint16_t offset = 0;
+    uint16_t capture_len = 0;
+    uint16_t part_len;
+    uint16_t opcode, len;
+    uint32_t sets = 0;
+    uint32_t i;
+    const test_event_t *p_event;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG, &enable, 1);
+    for (i = 0; i < 30; i++)
+    {
+        test_set(MESH_SIM_SERVER(i), (uint16_t)i, 3000);
+        mesh_sim_run(10);
+    }
+    enable = 0;
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG, &enable, 1);
+
+    do
+    {
+        command[0] = (uint8_t)offset;
+        command[1] = (uint8_t)(offset >> 8);
+        test_clear_events();
+        test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ, command, sizeof(command));
+
+        TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA), 1);
+        p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA);
+        TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), offset);
+        capture_len = (uint16_t)(p_event->data[2] | (p_event->data[3] << 8));
+        part_len    = (uint16_t)(p_event->length - 6);
+        TEST_ASSERT(offset + part_len <= sizeof(capture));
+        memcpy(&capture[offset], &p_event->data[6], part_len);
+        offset += part_len;
+    } while (part_len != 0);
+
+    TEST_ASSERT_EQ(offset, capture_len);
+    TEST_ASSERT(capture_len > 200);
+
+    for (i = 0; i + MESH_LIGHT_CTL_CAPTURE_HDR_LEN <= capture_len; )
+    {
+        opcode = (uint16_t)(capture[i + 3] | (capture[i + 4] << 8));
+        len    = (uint16_t)(capture[i + 5] | (capture[i + 6] << 8));
+        if ((capture[i] == MESH_LIGHT_CTL_CAPTURE_COMMAND) && (opcode == HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET))
+            sets++;
+        i += MESH_LIGHT_CTL_CAPTURE_HDR_LEN + ((capture[i] == MESH_LIGHT_CTL_CAPTURE_EVENT) ? 0 : len);
+    }
+    TEST_ASSERT_EQ(i, capture_len);
+    TEST_ASSERT_EQ(sets, 30);
+}
+#endif
+
+/*
+ * TX complete of a message is matched to its request by the event, not by the destination:
+ * the unacknowledged set completes after 1 ms while the get sent before it to the same server
+ * waits 40 ms for its status, which completes the get before its own TX complete
+ */
+void test_tx_complete_matches_event(void)
+{
+    test_request_config(8, 1000, 0);
+    test_get(MESH_SIM_SERVER(0), MESH_LIGHT_CTL_CODEC_GET);
+    test_set_unacked(MESH_SIM_SERVER(0), 100, 3000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_TX, 1), 1);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, TEST_LATENCY_STAGE_TX, -1), 0);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, TEST_LATENCY_STAGE_RESPONSE, 6), 1);
+}
+
+/*
+ * Latencies are counted in the bucket of their power of two: an unacknowledged set sent at once is
+ * in bucket 0, its TX complete after 4 ms at the start of bucket 3, a status after 127 ms at the end
+ * of bucket 7. With a window of one the second acknowledged set waits for the status of the first,
+ * so its queue time is also 127 ms. A low power node holds both sets for 1000 ms first, which puts
+ * their queue times at the end of bucket 10 and in bucket 11.
+ */
+void test_latency_bucket_boundaries(void)
+{
+    test_request_config(1, 1000, 0);
+    test_set_unacked(MESH_SIM_SERVER(0), 100, 3000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_QUEUE, 0), 1);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_TX, 2), 0);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_TX, 3), 1);
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LATENCY_RESET, NULL, 0);
+    test_set(MESH_SIM_SERVER(1), 200, 3000);
+    test_set(MESH_SIM_SERVER(2), 300, 3000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_QUEUE, 10), 1);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_QUEUE, 11), 1);
+#else
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_QUEUE, 0), 1);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_QUEUE, 7), 1);
+#endif
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_RESPONSE, 7), 2);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_RESPONSE, 8), 0);
+}
+
+/*
+ * Without a request window messages from the host take no request table entry, so nothing is measured
+ */
+void test_no_entry_without_window(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < 6; i++)
+    {
+        test_set(MESH_SIM_SERVER(i), (uint16_t)i, 3000);
+        test_set_unacked(MESH_SIM_GROUP_ADDR, (uint16_t)i, 3000);
+        mesh_sim_run(10);
+    }
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, 12);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_QUEUE, -1), 0);
+    TEST_ASSERT_EQ(test_latency(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, TEST_LATENCY_STAGE_TX, -1), 0);
+}
+
+/*
+ * Client retries a tracked get twice, the model sends each attempt once although the header asks
+ * for 3 retransmissions
+ */
+void test_client_retries_without_model_retransmissions(void)
+{
+    uint8_t buffer[MESH_SIM_HDR_LEN];
+    const test_event_t *p_event;
+
+    test_request_config(8, 1000, 2);
+    mesh_sim_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, buffer, mesh_sim_command_hdr(buffer, MESH_SIM_SERVER(0), 0, WICED_TRUE, 3));
+    mesh_sim_run(5000);
+
+    TEST_ASSERT_EQ(mesh_sim_stats.transmissions, 3);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[6], MESH_LIGHT_CTL_CLIENT_RESULT_TIMEOUT);
+    TEST_ASSERT_EQ(p_event->data[7], 2);
+}
+
+/*
+ * Without client retries the model makes the retransmissions of the header, and the request
+ * fails as soon as the model gives up instead of at the client timeout
+ */
+void test_model_retransmissions_without_client_retries(void)
+{
+    uint8_t buffer[MESH_SIM_HDR_LEN];
+    const test_event_t *p_event;
+    uint32_t time;
+
+    test_request_config(8, 10000, 0);
+    mesh_sim_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, buffer, mesh_sim_command_hdr(buffer, MESH_SIM_SERVER(0), 0, WICED_TRUE, 3));
+    mesh_sim_run(5000);
+
+    TEST_ASSERT_EQ(mesh_sim_stats.transmissions, 4);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[6], MESH_LIGHT_CTL_CLIENT_RESULT_TIMEOUT);
+    TEST_ASSERT_EQ(p_event->data[7], 0);
+    time = (uint32_t)(p_event->data[8] | (p_event->data[9] << 8) | (p_event->data[10] << 16) | ((uint32_t)p_event->data[11] << 24));
+    TEST_ASSERT(time < 5000);
+}
+
+/*
+ * Command with element index MESH_LIGHT_CTL_CLIENT_ELEMENT_ANY is sent from a client element chosen by the client, and the
+ * command buffer of the host is not changed
+ */
+void test_element_any_leaves_command(void)
+{
+    uint8_t buffer[MESH_SIM_HDR_LEN];
+    uint8_t copy[MESH_SIM_HDR_LEN];
+    const test_event_t *p_event;
+
+    mesh_sim_command_hdr(buffer, MESH_SIM_SERVER(2), MESH_LIGHT_CTL_CLIENT_ELEMENT_ANY, WICED_TRUE, 0);
+    memcpy(copy, buffer, sizeof(buffer));
+    wiced_bt_mesh_app_func_table.p_mesh_app_proc_rx_cmd(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, buffer, sizeof(buffer));
+    TEST_ASSERT(memcmp(buffer, copy, sizeof(buffer)) == 0);
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT_EQ(mesh_sim_servers[2].received, 1);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS)) != NULL);
+    TEST_ASSERT(p_event->data[4] < MESH_LIGHT_CTL_CLIENT_ELEMENTS);
+}
+
+/*
+ * Light CTL Set waiting to be coalesced is sent before a later Light CTL Temperature Set to the
+ * same destination, so the server ends with the temperature sent last by the host
+ */
+void test_coalesce_keeps_order(void)
+{
+    uint8_t config[2] = { 100, 0 };
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_COALESCE_CONFIG, config, sizeof(config));
+    test_set(MESH_SIM_SERVER(4), 1000, 3000);
+    test_set(MESH_SIM_SERVER(4), 2000, 4000);
+    test_temperature_set(MESH_SIM_SERVER(4), 5000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT_EQ(mesh_sim_servers[4].received, 3);
+    TEST_ASSERT_EQ(mesh_sim_servers[4].present.lightness, 2000);
+    TEST_ASSERT_EQ(mesh_sim_servers[4].present.temperature, 5000);
+}
+
+/*
+ * Configuration command shorter than its fields, or with a value which is not valid, is
+ * answered with a command status
+ */
+void test_short_config_command_status(void)
+{
+    static const uint16_t opcodes[] =
+    {
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_COALESCE_CONFIG,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_CONFIG,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CREDIT_CONFIG,
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_CONFIG,
+#endif
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG,
+#endif
+    };
+    uint8_t empty[1] = { 0 };
+    const test_event_t *p_event;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(opcodes) / sizeof(opcodes[0]); i++)
+    {
+        test_clear_events();
+        test_config_command(opcodes[i], empty, 0);
+        TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+        TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), opcodes[i]);
+        TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+    }
+
+    // Request timeout 0
+    test_clear_events();
+    test_request_config(4, 0, 0);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+}
+
+/*
+ * Destination lists shorter than their count are refused and nothing is sent
+ */
+void test_set_multi_bad_length(void)
+{
+    uint16_t set_len = mesh_light_ctl_codec_length(&mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_SET], WICED_TRUE);
+    uint8_t buffer[32];
+    const test_event_t *p_event;
+
+    // Set value and two destinations, with only the first one present
+    memset(buffer, 0, sizeof(buffer));
+    buffer[set_len]     = 2;
+    buffer[set_len + 1] = (uint8_t)MESH_SIM_SERVER(1);
+    buffer[set_len + 2] = (uint8_t)(MESH_SIM_SERVER(1) >> 8);
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST, 0, buffer, set_len + 3);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+
+    // Two entries of destination and set value, with only the first one present
+    test_clear_events();
+    buffer[0] = 2;
+    buffer[1] = (uint8_t)MESH_SIM_SERVER(1);
+    buffer[2] = (uint8_t)(MESH_SIM_SERVER(1) >> 8);
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI, 0, buffer, 3 + set_len);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+
+    mesh_sim_run(100);
+    TEST_ASSERT_EQ(mesh_sim_servers[1].received, 0);
+    TEST_ASSERT_EQ(mesh_sim_stats.events_in_use, 0);
+}
+
+/*
+ * Sweep of a list gets the state of each server, two at a time, and reports the values of all of
+ * them in the last result event
+ */
+void test_sweep_reports_each_server(void)
+{
+    uint8_t sweep[3 + 3 * 2] = { 0, 2, 3 };         // CTL state, 2 gets in flight, 3 addresses
+    const test_event_t *p_event;
+    const uint8_t *p;
+    uint32_t i;
+
+    for (i = 0; i < 3; i++)
+    {
+        sweep[3 + 2 * i] = (uint8_t)MESH_SIM_SERVER(10 + i);
+        sweep[4 + 2 * i] = (uint8_t)(MESH_SIM_SERVER(10 + i) >> 8);
+        mesh_sim_servers[10 + i].present.lightness   = (uint16_t)(1000 * (i + 1));
+        mesh_sim_servers[10 + i].present.temperature = (uint16_t)(3000 + 100 * i);
+    }
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, 0, sweep, sizeof(sweep));
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    TEST_ASSERT(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS) == NULL);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SWEEP_RESULT)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[0], 1);
+    TEST_ASSERT_EQ(p_event->data[1], 3);
+    TEST_ASSERT_EQ(p_event->length, 2 + 3 * 7);
+    for (i = 0; i < 3; i++)
+    {
+        p = &p_event->data[2 + 7 * i];
+        TEST_ASSERT_EQ(p[0] | (p[1] << 8), MESH_SIM_SERVER(10 + i));
+        TEST_ASSERT_EQ(p[2] | (p[3] << 8), 1000 * (i + 1));
+        TEST_ASSERT_EQ(p[4] | (p[5] << 8), 3000 + 100 * i);
+        TEST_ASSERT_EQ(p[6], MESH_LIGHT_CTL_CLIENT_RESULT_SUCCESS);
+        TEST_ASSERT_EQ(mesh_sim_servers[10 + i].received, 1);
+    }
+}
+
+/*
+ * Sweeps with missing addresses or bad values are refused and nothing is sent
+ */
+void test_sweep_bad_command(void)
+{
+    static const struct
+    {
+        uint8_t  data[7];
+        uint32_t length;
+        uint8_t  status;
+    } sweeps[] =
+    {
+        { { 0, 1, 2, 0x00, 0x01 },          5, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH },     // Second address missing
+        { { 0, 1, 0, 0x00, 0x01 },          5, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH },     // Last address missing
+        { { 3, 1, 1, 0x00, 0x01 },          5, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE },      // Unknown state
+        { { 0, 1, 1, 0x00, 0xC0 },          5, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE },      // Group address
+        { { 0, 1, 0, 0x10, 0x01, 0x00, 0x01 }, 7, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE },   // Last before first
+    };
+    const test_event_t *p_event;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(sweeps) / sizeof(sweeps[0]); i++)
+    {
+        test_clear_events();
+        test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, 0, sweeps[i].data, sweeps[i].length);
+        TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+        TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP);
+        TEST_ASSERT_EQ(p_event->data[2], sweeps[i].status);
+    }
+    mesh_sim_run(100);
+    TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, 0);
+    TEST_ASSERT_EQ(mesh_sim_stats.events_in_use, 0);
+}
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+/*
+ * Held messages are sent when the mesh core goes to sleep after a friend poll instead of at the end
+ * of the hold time, and a sleep with nothing held does not count as a wake window
+ */
+void test_lpn_sleep_sends_held(void)
+{
+    uint8_t clear = 1;
+    const test_event_t *p_event;
+    const uint8_t *p;
+
+    mesh_sim_lpn_sleep(5000);
+    test_set(MESH_SIM_SERVER(7), 500, 3000);
+    test_set(MESH_SIM_SERVER(8), 600, 3000);
+    mesh_sim_run(100);
+    TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, 0);
+
+    mesh_sim_lpn_sleep(5000);
+    TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, 2);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[7].present.lightness, 500);
+    TEST_ASSERT_EQ(mesh_sim_servers[8].present.lightness, 600);
+
+    test_clear_events();
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LPN_STATS_GET, &clear, 1);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LPN_STATS)) != NULL);
+    TEST_ASSERT_EQ(p_event->length, 14);
+    p = p_event->data;
+    TEST_ASSERT_EQ(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24), 2);     // Messages held
+    TEST_ASSERT_EQ(p[4] | (p[5] << 8) | (p[6] << 16) | ((uint32_t)p[7] << 24), 1);     // Wake windows
+    TEST_ASSERT_EQ(p[8] | (p[9] << 8) | (p[10] << 16) | ((uint32_t)p[11] << 24), 1);   // After a poll
+}
+#endif
+
+#if !defined(LOW_POWER_NODE) || (LOW_POWER_NODE == 0)
+/*
+ * Acknowledged sets to a group are sent one slot per expected server apart. A network size of 0
+ * is refused and keeps the spacing. A low power node sends held messages together when it wakes,
+ * so the test only runs without it.
+ */
+void test_stagger_spreads_group_sets(void)
+{
+    uint8_t config[6] = { 10, 0, 8, 0, 0, 0 };      // 10 ms slots, 8 servers, no jitter
+    const test_event_t *p_event;
+    uint32_t i;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG, config, sizeof(config));
+    config[2] = 0;
+    test_clear_events();
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG, config, sizeof(config));
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+
+    for (i = 0; i < 4; i++)
+        test_set(MESH_SIM_GROUP_ADDR, (uint16_t)(100 + i), 3000);
+
+    // One set every 80 ms
+    for (i = 1; i <= 4; i++)
+    {
+        TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, i);
+        mesh_sim_run(79);
+        TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, i);
+        mesh_sim_run(1);
+    }
+    TEST_ASSERT_EQ(mesh_sim_stats.mesh_messages, 4);
+
+    config[0] = 0;
+    config[2] = 8;
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG, config, sizeof(config));
+    mesh_sim_run(TEST_SETTLE_TIME);
+}
+#endif
+
+/*
+ * Sets to servers which are not in the cache do not take the cache entries of other servers
+ * when the range is checked
+ */
+void test_range_check_keeps_cache(void)
+{
+    uint8_t range_config[1] = { 1 };        // Clamp
+    uint16_t i;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG, range_config, sizeof(range_config));
+    test_get(MESH_SIM_SERVER(0), MESH_LIGHT_CTL_CODEC_GET);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[0].received, 1);
+
+    // As many other servers as the cache holds, a few at a time for the stagger queue of a low power node
+    for (i = 1; i <= 32; i++)
+    {
+        test_set_unacked(MESH_SIM_SERVER(i), 1000, 3000);
+        if ((i % 8) == 0)
+            mesh_sim_run(TEST_SETTLE_TIME);
+    }
+
+    // Server 0 is answered from the cache
+    test_clear_events();
+    test_get_cached(MESH_SIM_SERVER(0), MESH_LIGHT_CTL_CODEC_GET, 60000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[0].received, 1);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHED_STATUS), 1);
+}
+
+/*
+ * First set to a server which is not in the cache is sent as is and fetches the range of the
+ * server, which clamps the next set
+ */
+void test_range_fetched_for_new_server(void)
+{
+    uint8_t range_config[1] = { 1 };        // Clamp
+    const test_event_t *p_event;
+
+    mesh_sim_servers[9].range_min = 2000;
+    mesh_sim_servers[9].range_max = 6000;
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG, range_config, sizeof(range_config));
+
+    test_clear_events();
+    test_set(MESH_SIM_SERVER(9), 1000, 7000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[9].received, 2);
+    TEST_ASSERT(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS) == NULL);
+
+    test_clear_events();
+    test_set(MESH_SIM_SERVER(9), 1000, 7000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[9].received, 3);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_CLAMPED);
+}
+
+/*
+ * Curve uploaded at its first keyframe starts the transition to the second one at once, and the
+ * transition to the third one when the second is reached
+ */
+void test_curve_steps_through_keyframes(void)
+{
+    static const uint16_t keyframes[] = { 600, 1000, 3000, 660, 2000, 4000, 720, 1000, 3000 };
+    uint8_t buffer[7 + 3 * 6];
+
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_SIM_SERVER(11), buffer, test_curve(buffer, 600, keyframes, 3));
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS) == NULL);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].received, 1);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].present.lightness, 2000);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].present.temperature, 4000);
+
+    // Next set goes out up to a second before the transition starts
+    mesh_sim_run(60 * 60000 - 1000 - TEST_SETTLE_TIME - 1);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].received, 1);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].received, 2);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].present.lightness, 1000);
+    TEST_ASSERT_EQ(mesh_sim_servers[11].present.temperature, 3000);
+}
+
+/*
+ * Curves with missing keyframes or keyframes out of order are refused, and the curve already
+ * running for the destination goes on
+ */
+void test_curve_refused_keeps_curve(void)
+{
+    static const uint16_t keyframes[] = { 600, 1000, 3000, 660, 2000, 4000, 720, 500, 2500 };
+    static const uint16_t unordered[] = { 600, 1000, 3000, 540, 2000, 4000 };
+    uint8_t buffer[7 + 3 * 6];
+    const test_event_t *p_event;
+    uint32_t length;
+
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_SIM_SERVER(12), buffer, test_curve(buffer, 600, keyframes, 3));
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[12].received, 1);
+
+    test_clear_events();
+    length = test_curve(buffer, 610, unordered, 2);
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_SIM_SERVER(12), buffer, length);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+
+    test_clear_events();
+    test_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_SIM_SERVER(12), buffer, length - 1);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[2], MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+
+    // The first curve reaches its second keyframe and goes on to the third one
+    mesh_sim_run(60 * 60000);
+    TEST_ASSERT_EQ(mesh_sim_servers[12].received, 2);
+    TEST_ASSERT_EQ(mesh_sim_servers[12].present.lightness, 500);
+    TEST_ASSERT_EQ(mesh_sim_stats.events_in_use, 0);
+}
+
+/*
+ * Get answered from the cache is reported in its own event, with the state and the age of the
+ * status of the requested kind
+ */
+void test_cached_status_per_kind(void)
+{
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    uint32_t ctl_age, temperature_age;
+    uint16_t src;
+
+    mesh_sim_servers[6].present.lightness   = 1000;
+    mesh_sim_servers[6].present.temperature = 3000;
+    test_get(MESH_SIM_SERVER(6), MESH_LIGHT_CTL_CODEC_GET);
+    mesh_sim_run(TEST_SETTLE_TIME);
+
+    mesh_sim_servers[6].present.temperature = 5000;
+    test_get(MESH_SIM_SERVER(6), MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[6].received, 2);
+
+    test_clear_events();
+    test_get_cached(MESH_SIM_SERVER(6), MESH_LIGHT_CTL_CODEC_GET, 60000);
+    TEST_ASSERT(test_decode_cached_status(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHED_STATUS), MESH_LIGHT_CTL_CODEC_STATUS, &src, &ctl_age, &status));
+    TEST_ASSERT_EQ(src, MESH_SIM_SERVER(6));
+    TEST_ASSERT_EQ(status.present.lightness, 1000);
+    TEST_ASSERT_EQ(status.present.temperature, 3000);
+
+    test_get_cached(MESH_SIM_SERVER(6), MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET, 60000);
+    TEST_ASSERT(test_decode_cached_status(test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHED_STATUS), MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS, &src, &temperature_age, &status));
+    TEST_ASSERT_EQ(src, MESH_SIM_SERVER(6));
+    TEST_ASSERT_EQ(status.present.temperature, 5000);
+    TEST_ASSERT(ctl_age >= temperature_age + TEST_SETTLE_TIME - 100);
+
+    // Nothing answered from the cache looks like a status received from the server
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), 0);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_STATUS), 0);
+    TEST_ASSERT_EQ(mesh_sim_servers[6].received, 2);
+}
+
+/*
+ * Change only forwarding without a request window or heartbeat drops an unchanged status nobody
+ * asked for, but not the unchanged reply to a get of the host
+ */
+void test_filter_forwards_get_reply(void)
+{
+    uint8_t filter_config[3] = { 1, 0, 0 };         // Enabled, no heartbeat
+    wiced_bt_mesh_light_ctl_status_data_t status;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_CONFIG, filter_config, sizeof(filter_config));
+    test_get(MESH_SIM_SERVER(13), MESH_LIGHT_CTL_CODEC_GET);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), 1);
+
+    // Same state published by the server twice, the server was not in the cache for the reply
+    memset(&status, 0, sizeof(status));
+    status.present = mesh_sim_servers[13].present;
+    status.target  = mesh_sim_servers[13].present;
+    mesh_sim_status(WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_SERVER(13), &status);
+    mesh_sim_status(WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_SERVER(13), &status);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), 2);
+
+    test_get(MESH_SIM_SERVER(13), MESH_LIGHT_CTL_CODEC_GET);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    TEST_ASSERT_EQ(mesh_sim_servers[13].received, 2);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), 3);
+}
+
+/*
+ * Host which sends a command only when it holds a credit never has a command refused, even with
+ * no more mesh events than the client budget, and receives every event in sequence
+ */
+void test_credits_follow_free_events(void)
+{
+    uint8_t enable = 1;
+    const test_event_t *p_event;
+    uint32_t i;
+    uint32_t credits = 0;
+    uint32_t sent = 0;
+    uint32_t waits = 0;
+    uint16_t seq = 0;
+    uint16_t opcode;
+    uint16_t overruns = 0xffff;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CREDIT_CONFIG, &enable, 1);
+    while (sent <= 100)
+    {
+        for (i = 0; i < test_num_events; i++)
+        {
+            p_event = &test_events[i];
+            if (p_event->opcode != HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SEQUENCED)
+                continue;
+            TEST_ASSERT_EQ(p_event->data[0] | (p_event->data[1] << 8), seq);
+            seq++;
+            opcode = (uint16_t)(p_event->data[2] | (p_event->data[3] << 8));
+            TEST_ASSERT(opcode != HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS);
+            if (opcode == HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CREDIT)
+            {
+                credits  = p_event->data[5];
+                overruns = (uint16_t)(p_event->data[6] | (p_event->data[7] << 8));
+            }
+        }
+        test_clear_events();
+        if (sent == 100)
+            break;
+        if (credits == 0)
+        {
+            waits++;
+            mesh_sim_run(1);
+            continue;
+        }
+        test_set_unacked(MESH_SIM_SERVER(sent % 32), (uint16_t)sent, 3000);
+        credits--;
+        sent++;
+    }
+
+    // The host had to wait for credits, and never sent a command without one
+    TEST_ASSERT(waits > 0);
+    TEST_ASSERT_EQ(overruns, 0);
+}
+
+/*
+ * Batched statuses are sent in the order received, and all of them before a later TX complete
+ */
+void test_status_batch_before_tx_complete(void)
+{
+    uint8_t batch_config[2] = { 0x60, 0xEA };      // 60 s, longer than the test
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    const test_event_t *p_batch = NULL;
+    uint32_t tx_complete = 0;
+    uint32_t i, offset;
+    uint16_t src;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG, batch_config, sizeof(batch_config));
+    memset(&status, 0, sizeof(status));
+    for (i = 1; i <= 3; i++)
+    {
+        status.present.lightness = (uint16_t)(i * 100);
+        mesh_sim_status(WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_SERVER(i), &status);
+    }
+    mesh_sim_run(100);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), 0);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH), 0);
+
+    // The TX complete of an unacknowledged set flushes the batch first
+    test_clear_events();
+    test_set_unacked(MESH_SIM_SERVER(5), 500, 5000);
+    mesh_sim_run(TEST_SETTLE_TIME);
+    for (i = 0; i < test_num_events; i++)
+    {
+        if ((test_events[i].opcode == HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH) && (p_batch == NULL))
+            p_batch = &test_events[i];
+        if ((test_events[i].opcode == HCI_CONTROL_MESH_EVENT_TX_COMPLETE) && (tx_complete == 0))
+            tx_complete = i + 1;
+    }
+    TEST_ASSERT(p_batch != NULL);
+    TEST_ASSERT(tx_complete != 0);
+    TEST_ASSERT(p_batch < &test_events[tx_complete - 1]);
+
+    // Records of opcode, length and status event, in the order received
+    for (i = 1, offset = 0; i <= 3; i++)
+    {
+        TEST_ASSERT(offset + 3 <= p_batch->length);
+        TEST_ASSERT_EQ(p_batch->data[offset] | (p_batch->data[offset + 1] << 8), HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS);
+        src = (uint16_t)(p_batch->data[offset + 3] | (p_batch->data[offset + 4] << 8));
+        TEST_ASSERT_EQ(src, MESH_SIM_SERVER(i));
+        TEST_ASSERT_EQ(p_batch->data[offset + 3 + TEST_HCI_EVENT_HDR_LEN] | (p_batch->data[offset + 4 + TEST_HCI_EVENT_HDR_LEN] << 8), i * 100);
+        offset += 3 + p_batch->data[offset + 2];
+    }
+    TEST_ASSERT_EQ(offset, p_batch->length);
+    TEST_ASSERT_EQ(test_count_events(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS), 0);
+
+    // A batch which is waiting is sent when batching is disabled
+    mesh_sim_status(WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_SERVER(6), &status);
+    test_clear_events();
+    batch_config[0] = batch_config[1] = 0;
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG, batch_config, sizeof(batch_config));
+    TEST_ASSERT((p_batch = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH)) != NULL);
+    TEST_ASSERT_EQ(p_batch->data[3] | (p_batch->data[4] << 8), MESH_SIM_SERVER(6));
+}
+
+/*
+ * Usage statistics count the statuses sent to the host and the longest batch
+ */
+void test_pool_stats_count_statuses(void)
+{
+    uint8_t batch_config[2] = { 20, 0 };
+    uint8_t clear[1] = { 1 };
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    const test_event_t *p_event;
+    const test_event_t *p_batch;
+    uint32_t i;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG, batch_config, sizeof(batch_config));
+    memset(&status, 0, sizeof(status));
+    for (i = 0; i < 3; i++)
+        mesh_sim_status(WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_SERVER(i), &status);
+    mesh_sim_run(100);
+    TEST_ASSERT((p_batch = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH)) != NULL);
+
+    // Statistics are sent on their own
+    batch_config[0] = 0;
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG, batch_config, sizeof(batch_config));
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_POOL_STATS_GET, clear, sizeof(clear));
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_POOL_STATS)) != NULL);
+    TEST_ASSERT_EQ(p_event->length, 17);
+    TEST_ASSERT_EQ(p_event->data[7] | (p_event->data[8] << 8) | (p_event->data[9] << 16) | ((uint32_t)p_event->data[10] << 24), 3);
+    TEST_ASSERT_EQ(p_event->data[11] | (p_event->data[12] << 8), p_batch->length);
+    TEST_ASSERT_EQ(p_event->data[15] | (p_event->data[16] << 8), 0);
+
+    // Cleared after the read
+    test_clear_events();
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_POOL_STATS_GET, NULL, 0);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_POOL_STATS)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[7] | (p_event->data[8] << 8), 0);
+    TEST_ASSERT_EQ(p_event->data[11] | (p_event->data[12] << 8), 0);
+}
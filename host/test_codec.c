@@ -0,0 +1,365 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Tests of the Light CTL message tables. Every message is decoded and encoded with the tables
+ * and with the STREAM_TO_UINT and UINT_TO_STREAM sequences which the client used before the
+ * tables, and both must agree.
+ *
+ * Usage: test_codec [test names]
+ */
+#include <string.h>
+#include "test.h"
+#include "mesh_light_ctl_codec.h"
+
+/******************************************************
+ *          Constants
+ ******************************************************/
+#define TEST_CODEC_MAX_LEN          32
+#define TEST_CODEC_ROUNDS           64      // Random messages per message type
+
+/******************************************************
+ *          Structures
+ ******************************************************/
+// Any decoded message
+typedef union
+{
+    mesh_light_ctl_codec_get_t                                  get;
+    wiced_bt_mesh_light_ctl_set_t                               set;
+    wiced_bt_mesh_light_ctl_temperature_set_t                   temperature_set;
+    wiced_bt_mesh_light_ctl_temperature_range_data_t            temperature_range_set;
+    wiced_bt_mesh_light_ctl_default_data_t                      default_data;
+    wiced_bt_mesh_light_ctl_status_data_t                       status;
+    wiced_bt_mesh_light_ctl_temperature_range_status_data_t     temperature_range_status;
+} test_codec_struct_t;
+
+// Layout of a message as written out in the client before the tables, NULL if the message had no data
+typedef struct
+{
+    void (*p_read)(uint8_t *p, test_codec_struct_t *p_struct);
+    uint8_t *(*p_write)(uint8_t *p, const test_codec_struct_t *p_struct);
+} test_codec_layout_t;
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static void test_codec_set_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_set_write(uint8_t *p, const test_codec_struct_t *p_struct);
+static void test_codec_temperature_set_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_temperature_set_write(uint8_t *p, const test_codec_struct_t *p_struct);
+static void test_codec_temperature_range_set_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_temperature_range_set_write(uint8_t *p, const test_codec_struct_t *p_struct);
+static void test_codec_default_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_default_write(uint8_t *p, const test_codec_struct_t *p_struct);
+static void test_codec_status_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_status_write(uint8_t *p, const test_codec_struct_t *p_struct);
+static void test_codec_temperature_status_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_temperature_status_write(uint8_t *p, const test_codec_struct_t *p_struct);
+static void test_codec_temperature_range_status_read(uint8_t *p, test_codec_struct_t *p_struct);
+static uint8_t *test_codec_temperature_range_status_write(uint8_t *p, const test_codec_struct_t *p_struct);
+
+static void test_codec_same_as_stream(void);
+static void test_codec_get_max_age(void);
+static void test_codec_short_message(void);
+static void test_codec_find(void);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+static const test_codec_layout_t test_codec_layouts[MESH_LIGHT_CTL_CODEC_NUM_MESSAGES] =
+{
+    [MESH_LIGHT_CTL_CODEC_SET]                      = { test_codec_set_read, test_codec_set_write },
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET]          = { test_codec_temperature_set_read, test_codec_temperature_set_write },
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_SET]    = { test_codec_temperature_range_set_read, test_codec_temperature_range_set_write },
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_SET]              = { test_codec_default_read, test_codec_default_write },
+    [MESH_LIGHT_CTL_CODEC_STATUS]                   = { test_codec_status_read, test_codec_status_write },
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS]       = { test_codec_temperature_status_read, test_codec_temperature_status_write },
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS] = { test_codec_temperature_range_status_read, test_codec_temperature_range_status_write },
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS]           = { test_codec_default_read, test_codec_default_write },
+};
+
+static const test_case_t test_cases[] =
+{
+    TEST_CASE(test_codec_same_as_stream),
+    TEST_CASE(test_codec_get_max_age),
+    TEST_CASE(test_codec_short_message),
+    TEST_CASE(test_codec_find),
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int main(int argc, char *argv[])
+{
+    return test_main(test_cases, sizeof(test_cases) / sizeof(test_cases[0]), NULL, argc, argv);
+}
+
+/*
+ * Random messages of every type with data are decoded to the same structure and encoded to
+ * the same bytes as with the stream macros
+ */
+void test_codec_same_as_stream(void)
+{
+    const mesh_light_ctl_codec_message_t *p_msg;
+    test_codec_struct_t old_struct, new_struct;
+    uint8_t message[TEST_CODEC_MAX_LEN];
+    uint8_t old_buffer[TEST_CODEC_MAX_LEN];
+    uint8_t new_buffer[TEST_CODEC_MAX_LEN];
+    uint16_t length, old_length;
+    uint32_t seed = 1;
+    uint32_t i, j, round;
+
+    for (i = 0; i < MESH_LIGHT_CTL_CODEC_NUM_MESSAGES; i++)
+    {
+        p_msg = &mesh_light_ctl_codec_messages[i];
+        if (test_codec_layouts[i].p_read == NULL)
+            continue;
+
+        length = mesh_light_ctl_codec_length(p_msg, WICED_TRUE);
+        TEST_ASSERT(length <= TEST_CODEC_MAX_LEN);
+        for (round = 0; round < TEST_CODEC_ROUNDS; round++)
+        {
+            for (j = 0; j < length; j++)
+            {
+                seed = seed * 1103515245 + 12345;
+                message[j] = (uint8_t)(seed >> 16);
+            }
+            memset(&old_struct, 0, sizeof(old_struct));
+            memset(&new_struct, 0, sizeof(new_struct));
+            test_codec_layouts[i].p_read(message, &old_struct);
+            TEST_ASSERT_EQ(mesh_light_ctl_codec_decode(p_msg, message, length, &new_struct), length);
+            TEST_ASSERT(memcmp(&old_struct, &new_struct, sizeof(old_struct)) == 0);
+
+            old_length = (uint16_t)(test_codec_layouts[i].p_write(old_buffer, &old_struct) - old_buffer);
+            TEST_ASSERT_EQ(old_length, length);
+            TEST_ASSERT_EQ(mesh_light_ctl_codec_encode(p_msg, &old_struct, new_buffer, sizeof(new_buffer)), length);
+            TEST_ASSERT(memcmp(old_buffer, new_buffer, length) == 0);
+            TEST_ASSERT(memcmp(message, new_buffer, length) == 0);
+        }
+    }
+}
+
+/*
+ * Get commands had no data, the maximum age is optional
+ */
+void test_codec_get_max_age(void)
+{
+    static const uint8_t gets[] = { MESH_LIGHT_CTL_CODEC_GET, MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET,
+                                    MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_GET, MESH_LIGHT_CTL_CODEC_DEFAULT_GET };
+    const mesh_light_ctl_codec_message_t *p_msg;
+    mesh_light_ctl_codec_get_t get;
+    uint8_t buffer[TEST_CODEC_MAX_LEN];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(gets); i++)
+    {
+        p_msg = &mesh_light_ctl_codec_messages[gets[i]];
+        TEST_ASSERT(test_codec_layouts[gets[i]].p_read == NULL);
+
+        get.max_age = 0;
+        TEST_ASSERT_EQ(mesh_light_ctl_codec_decode(p_msg, buffer, 0, &get), 0);
+        TEST_ASSERT_EQ(get.max_age, 0);
+
+        get.max_age = 0x1234;
+        TEST_ASSERT_EQ(mesh_light_ctl_codec_encode(p_msg, &get, buffer, sizeof(buffer)), 2);
+        TEST_ASSERT_EQ(buffer[0], 0x34);
+        TEST_ASSERT_EQ(buffer[1], 0x12);
+        get.max_age = 0;
+        TEST_ASSERT_EQ(mesh_light_ctl_codec_decode(p_msg, buffer, 2, &get), 2);
+        TEST_ASSERT_EQ(get.max_age, 0x1234);
+    }
+}
+
+/*
+ * Message without all its required fields is not decoded, and is not encoded into a buffer
+ * which is too small
+ */
+void test_codec_short_message(void)
+{
+    const mesh_light_ctl_codec_message_t *p_msg;
+    test_codec_struct_t data;
+    uint8_t buffer[TEST_CODEC_MAX_LEN];
+    uint16_t required, length;
+    uint32_t i;
+
+    memset(&data, 0, sizeof(data));
+    memset(buffer, 0, sizeof(buffer));
+    for (i = 0; i < MESH_LIGHT_CTL_CODEC_NUM_MESSAGES; i++)
+    {
+        p_msg    = &mesh_light_ctl_codec_messages[i];
+        required = mesh_light_ctl_codec_length(p_msg, WICED_FALSE);
+        length   = mesh_light_ctl_codec_length(p_msg, WICED_TRUE);
+        if (required != 0)
+            TEST_ASSERT_EQ(mesh_light_ctl_codec_decode(p_msg, buffer, required - 1U, &data), MESH_LIGHT_CTL_CODEC_ERROR);
+        TEST_ASSERT_EQ(mesh_light_ctl_codec_decode(p_msg, buffer, required, &data), required);
+        TEST_ASSERT_EQ(mesh_light_ctl_codec_encode(p_msg, &data, buffer, length - 1U), MESH_LIGHT_CTL_CODEC_ERROR);
+    }
+}
+
+/*
+ * Every message is found by its opcode, opcodes of another group are not found
+ */
+void test_codec_find(void)
+{
+    const mesh_light_ctl_codec_message_t *p_msg;
+    uint32_t i;
+
+    for (i = 0; i < MESH_LIGHT_CTL_CODEC_NUM_MESSAGES; i++)
+    {
+        p_msg = &mesh_light_ctl_codec_messages[i];
+        if (i < MESH_LIGHT_CTL_CODEC_NUM_COMMANDS)
+            TEST_ASSERT(mesh_light_ctl_codec_find_command(p_msg->opcode) == p_msg);
+        else
+            TEST_ASSERT(mesh_light_ctl_codec_find_event(p_msg->opcode) == p_msg);
+    }
+    TEST_ASSERT(mesh_light_ctl_codec_find_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET + 0x100) == NULL);
+}
+
+void test_codec_set_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT16(p_struct->set.target.lightness, p);
+    STREAM_TO_UINT16(p_struct->set.target.temperature, p);
+    STREAM_TO_UINT16(p_struct->set.target.delta_uv, p);
+    STREAM_TO_UINT32(p_struct->set.transition_time, p);
+    STREAM_TO_UINT16(p_struct->set.delay, p);
+}
+
+uint8_t *test_codec_set_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT16_TO_STREAM(p, p_struct->set.target.lightness);
+    UINT16_TO_STREAM(p, p_struct->set.target.temperature);
+    UINT16_TO_STREAM(p, p_struct->set.target.delta_uv);
+    UINT32_TO_STREAM(p, p_struct->set.transition_time);
+    UINT16_TO_STREAM(p, p_struct->set.delay);
+    return p;
+}
+
+void test_codec_temperature_set_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT16(p_struct->temperature_set.target_temperature, p);
+    STREAM_TO_UINT16(p_struct->temperature_set.target_delta_uv, p);
+    STREAM_TO_UINT32(p_struct->temperature_set.transition_time, p);
+    STREAM_TO_UINT16(p_struct->temperature_set.delay, p);
+}
+
+uint8_t *test_codec_temperature_set_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT16_TO_STREAM(p, p_struct->temperature_set.target_temperature);
+    UINT16_TO_STREAM(p, p_struct->temperature_set.target_delta_uv);
+    UINT32_TO_STREAM(p, p_struct->temperature_set.transition_time);
+    UINT16_TO_STREAM(p, p_struct->temperature_set.delay);
+    return p;
+}
+
+void test_codec_temperature_range_set_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT16(p_struct->temperature_range_set.min_level, p);
+    STREAM_TO_UINT16(p_struct->temperature_range_set.max_level, p);
+}
+
+uint8_t *test_codec_temperature_range_set_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT16_TO_STREAM(p, p_struct->temperature_range_set.min_level);
+    UINT16_TO_STREAM(p, p_struct->temperature_range_set.max_level);
+    return p;
+}
+
+// Default Set command and Default Status event
+void test_codec_default_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT16(p_struct->default_data.default_status.lightness, p);
+    STREAM_TO_UINT16(p_struct->default_data.default_status.temperature, p);
+    STREAM_TO_UINT16(p_struct->default_data.default_status.delta_uv, p);
+}
+
+uint8_t *test_codec_default_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT16_TO_STREAM(p, p_struct->default_data.default_status.lightness);
+    UINT16_TO_STREAM(p, p_struct->default_data.default_status.temperature);
+    UINT16_TO_STREAM(p, p_struct->default_data.default_status.delta_uv);
+    return p;
+}
+
+void test_codec_status_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT16(p_struct->status.present.lightness, p);
+    STREAM_TO_UINT16(p_struct->status.present.temperature, p);
+    STREAM_TO_UINT16(p_struct->status.target.lightness, p);
+    STREAM_TO_UINT16(p_struct->status.target.temperature, p);
+    STREAM_TO_UINT32(p_struct->status.remaining_time, p);
+}
+
+uint8_t *test_codec_status_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT16_TO_STREAM(p, p_struct->status.present.lightness);
+    UINT16_TO_STREAM(p, p_struct->status.present.temperature);
+    UINT16_TO_STREAM(p, p_struct->status.target.lightness);
+    UINT16_TO_STREAM(p, p_struct->status.target.temperature);
+    UINT32_TO_STREAM(p, p_struct->status.remaining_time);
+    return p;
+}
+
+void test_codec_temperature_status_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT16(p_struct->status.present.temperature, p);
+    STREAM_TO_UINT16(p_struct->status.present.delta_uv, p);
+    STREAM_TO_UINT16(p_struct->status.target.temperature, p);
+    STREAM_TO_UINT16(p_struct->status.target.delta_uv, p);
+    STREAM_TO_UINT32(p_struct->status.remaining_time, p);
+}
+
+uint8_t *test_codec_temperature_status_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT16_TO_STREAM(p, p_struct->status.present.temperature);
+    UINT16_TO_STREAM(p, p_struct->status.present.delta_uv);
+    UINT16_TO_STREAM(p, p_struct->status.target.temperature);
+    UINT16_TO_STREAM(p, p_struct->status.target.delta_uv);
+    UINT32_TO_STREAM(p, p_struct->status.remaining_time);
+    return p;
+}
+
+void test_codec_temperature_range_status_read(uint8_t *p, test_codec_struct_t *p_struct)
+{
+    STREAM_TO_UINT8(p_struct->temperature_range_status.status, p);
+    STREAM_TO_UINT16(p_struct->temperature_range_status.min_level, p);
+    STREAM_TO_UINT16(p_struct->temperature_range_status.max_level, p);
+}
+
+uint8_t *test_codec_temperature_range_status_write(uint8_t *p, const test_codec_struct_t *p_struct)
+{
+    UINT8_TO_STREAM(p, p_struct->temperature_range_status.status);
+    UINT16_TO_STREAM(p, p_struct->temperature_range_status.min_level);
+    UINT16_TO_STREAM(p, p_struct->temperature_range_status.max_level);
+    return p;
+}
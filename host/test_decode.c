@@ -0,0 +1,272 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Tests of the decoder of trace records and captures. Records written in the layout of
+ * mesh_light_ctl_hci.h are decoded to the same values, and with BINARY_TRACE=1 or HCI_CAPTURE=1
+ * the trace records and the capture read from the client decode to the traffic which produced them.
+ *
+ * Usage: test_decode [test names]
+ */
+#include <string.h>
+#include "test.h"
+#include "hci_decode.h"
+#include "mesh_light_ctl_codec.h"
+#include "mesh_light_ctl_hci.h"
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static void test_decode_trace_round_trip(void);
+static void test_decode_capture_round_trip(void);
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+static void test_decode_client_trace(void);
+#endif
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+static void test_decode_client_capture(void);
+#endif
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+static const test_case_t test_cases[] =
+{
+    TEST_CASE(test_decode_trace_round_trip),
+    TEST_CASE(test_decode_capture_round_trip),
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+    TEST_CASE(test_decode_client_trace),
+#endif
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+    TEST_CASE(test_decode_client_capture),
+#endif
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+int main(int argc, char *argv[])
+{
+    return test_main(test_cases, sizeof(test_cases) / sizeof(test_cases[0]), NULL, argc, argv);
+}
+
+/*
+ * Trace data written in the event layout decodes to the same records, and each record is
+ * formatted with the format of its id
+ */
+void test_decode_trace_round_trip(void)
+{
+    hci_decode_trace_t written[3], decoded[MESH_LIGHT_CTL_TRACE_DATA_RECORDS];
+    uint8_t buffer[MESH_LIGHT_CTL_TRACE_DATA_HDR_LEN + MESH_LIGHT_CTL_TRACE_DATA_RECORDS * MESH_LIGHT_CTL_TRACE_RECORD_LEN];
+    uint8_t *p = buffer;
+    char text[160], expected[160];
+    uint16_t dropped;
+    uint32_t i, j;
+
+    memset(written, 0, sizeof(written));
+    written[0].time = 1000;
+    written[0].id   = MESH_LIGHT_CTL_TRACE_STATUS;
+    for (j = 0; j < 5; j++)
+        written[0].arg[j] = 100 * (j + 1);
+    written[1].time   = 1001;
+    written[1].id     = MESH_LIGHT_CTL_TRACE_CACHE_REPLY;
+    written[1].arg[0] = MESH_SIM_SERVER(3);
+    written[1].arg[1] = 1;
+    written[1].arg[2] = 250;
+    written[2].time   = 0x12345678;
+    written[2].id     = MESH_LIGHT_CTL_TRACE_NUM_IDS;
+
+    UINT16_TO_STREAM(p, 7);
+    UINT8_TO_STREAM(p, 3);
+    for (i = 0; i < 3; i++)
+    {
+        UINT32_TO_STREAM(p, written[i].time);
+        UINT8_TO_STREAM(p, written[i].id);
+        for (j = 0; j < 5; j++)
+            UINT32_TO_STREAM(p, written[i].arg[j]);
+    }
+    TEST_ASSERT_EQ(hci_decode_trace_data_len(buffer, sizeof(buffer)), p - buffer);
+    TEST_ASSERT_EQ(hci_decode_trace_data(buffer, (uint32_t)(p - buffer), &dropped, decoded, MESH_LIGHT_CTL_TRACE_DATA_RECORDS), 3);
+    TEST_ASSERT_EQ(dropped, 7);
+    for (i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_EQ(decoded[i].time, written[i].time);
+        TEST_ASSERT_EQ(decoded[i].id, written[i].id);
+        for (j = 0; j < 5; j++)
+            TEST_ASSERT_EQ(decoded[i].arg[j], written[i].arg[j]);
+    }
+
+    hci_decode_trace_format(text, sizeof(text), &decoded[0]);
+    snprintf(expected, sizeof(expected), MESH_LIGHT_CTL_TRACE_STATUS_FMT, 100, 200, 300, 400, 500);
+    TEST_ASSERT(strcmp(text, expected) == 0);
+    hci_decode_trace_format(text, sizeof(text), &decoded[1]);
+    TEST_ASSERT(strcmp(text, "ctl cache reply dst:0103 kind:1 age:250\n") == 0);
+    hci_decode_trace_format(text, sizeof(text), &decoded[2]);
+    snprintf(expected, sizeof(expected), "trace id:%d\n", MESH_LIGHT_CTL_TRACE_NUM_IDS);
+    TEST_ASSERT(strcmp(text, expected) == 0);
+
+    // Length which does not match the number of records
+    TEST_ASSERT_EQ(hci_decode_trace_data(buffer, (uint32_t)(p - buffer) - 1, &dropped, decoded, MESH_LIGHT_CTL_TRACE_DATA_RECORDS), HCI_DECODE_ERROR);
+    TEST_ASSERT_EQ(hci_decode_trace_data(buffer, (uint32_t)(p - buffer), &dropped, decoded, 2), HCI_DECODE_ERROR);
+}
+
+/*
+ * Capture records written in the capture layout decode to the same records, events without data
+ */
+void test_decode_capture_round_trip(void)
+{
+    static const uint8_t command[3] = { 1, 2, 3 };
+    uint8_t buffer[64];
+    uint8_t *p = buffer;
+    hci_decode_capture_t record;
+    uint32_t length, record_len;
+
+    UINT8_TO_STREAM(p, MESH_LIGHT_CTL_CAPTURE_COMMAND);
+    UINT16_TO_STREAM(p, 0);
+    UINT16_TO_STREAM(p, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET);
+    UINT16_TO_STREAM(p, sizeof(command));
+    memcpy(p, command, sizeof(command));
+    p += sizeof(command);
+    UINT8_TO_STREAM(p, MESH_LIGHT_CTL_CAPTURE_EVENT);
+    UINT16_TO_STREAM(p, 12);
+    UINT16_TO_STREAM(p, HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS);
+    UINT16_TO_STREAM(p, 17);
+    length = (uint32_t)(p - buffer);
+
+    TEST_ASSERT_EQ(record_len = hci_decode_capture(buffer, length, &record), MESH_LIGHT_CTL_CAPTURE_HDR_LEN + sizeof(command));
+    TEST_ASSERT_EQ(record.type, MESH_LIGHT_CTL_CAPTURE_COMMAND);
+    TEST_ASSERT_EQ(record.delta, 0);
+    TEST_ASSERT_EQ(record.opcode, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET);
+    TEST_ASSERT_EQ(record.length, sizeof(command));
+    TEST_ASSERT(memcmp(record.p_data, command, sizeof(command)) == 0);
+
+    TEST_ASSERT_EQ(hci_decode_capture(buffer + record_len, length - record_len, &record), MESH_LIGHT_CTL_CAPTURE_HDR_LEN);
+    TEST_ASSERT_EQ(record.type, MESH_LIGHT_CTL_CAPTURE_EVENT);
+    TEST_ASSERT_EQ(record.delta, 12);
+    TEST_ASSERT_EQ(record.opcode, HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS);
+    TEST_ASSERT_EQ(record.length, 17);
+    TEST_ASSERT(record.p_data == NULL);
+
+    // Command data cut short
+    TEST_ASSERT_EQ(hci_decode_capture(buffer, MESH_LIGHT_CTL_CAPTURE_HDR_LEN + 1, &record), 0);
+    TEST_ASSERT_EQ(hci_decode_capture(buffer, MESH_LIGHT_CTL_CAPTURE_HDR_LEN - 1, &record), 0);
+}
+
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+/*
+ * A status received by the client is read back as trace records with the values of the status
+ */
+void test_decode_client_trace(void)
+{
+    uint8_t drain_interval[2] = { 0, 0 };           // Keep the records for the read
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    hci_decode_trace_t records[MESH_LIGHT_CTL_TRACE_DATA_RECORDS];
+    const test_event_t *p_event;
+    uint16_t dropped;
+    uint32_t count;
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_CONFIG, drain_interval, sizeof(drain_interval));
+    memset(&status, 0, sizeof(status));
+    status.present.lightness   = 1000;
+    status.present.temperature = 3000;
+    status.target.lightness    = 2000;
+    status.target.temperature  = 4000;
+    status.remaining_time      = 500;
+    mesh_sim_status(WICED_BT_MESH_LIGHT_CTL_STATUS, MESH_SIM_SERVER(2), &status);
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_READ, NULL, 0);
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TRACE_DATA)) != NULL);
+    count = hci_decode_trace_data(p_event->data, p_event->length, &dropped, records, MESH_LIGHT_CTL_TRACE_DATA_RECORDS);
+    TEST_ASSERT_EQ(count, 2);
+    TEST_ASSERT_EQ(dropped, 0);
+    TEST_ASSERT_EQ(records[0].id, MESH_LIGHT_CTL_TRACE_MSG);
+    TEST_ASSERT_EQ(records[0].arg[0], WICED_BT_MESH_LIGHT_CTL_STATUS);
+    TEST_ASSERT_EQ(records[1].id, MESH_LIGHT_CTL_TRACE_STATUS);
+    TEST_ASSERT_EQ(records[1].time, wiced_bt_mesh_core_get_tick_count());
+    TEST_ASSERT_EQ(records[1].arg[0], 1000);
+    TEST_ASSERT_EQ(records[1].arg[1], 3000);
+    TEST_ASSERT_EQ(records[1].arg[2], 2000);
+    TEST_ASSERT_EQ(records[1].arg[3], 4000);
+    TEST_ASSERT_EQ(records[1].arg[4], 500);
+}
+#endif
+
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+/*
+ * A command captured by the client is read back with its opcode and data
+ */
+void test_decode_client_capture(void)
+{
+    wiced_bt_mesh_light_ctl_set_t set;
+    uint8_t command[MESH_SIM_HDR_LEN + 32];
+    uint8_t offset[2] = { 0, 0 };
+    uint8_t enable = 1;
+    hci_decode_capture_t record;
+    const test_event_t *p_event;
+    const uint8_t *p;
+    uint32_t length, record_len;
+    uint32_t hdr_len;
+    uint16_t set_len;
+    uint32_t sets = 0;
+
+    memset(&set, 0, sizeof(set));
+    set.target.lightness   = 1234;
+    set.target.temperature = 5678;
+    hdr_len = mesh_sim_command_hdr(command, MESH_SIM_SERVER(4), 0, WICED_TRUE, 0);
+    set_len = mesh_light_ctl_codec_encode(&mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_SET], &set, &command[hdr_len], sizeof(command) - hdr_len);
+    TEST_ASSERT(set_len != MESH_LIGHT_CTL_CODEC_ERROR);
+
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG, &enable, 1);
+    mesh_sim_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, command, hdr_len + set_len);
+    mesh_sim_run(100);
+    enable = 0;
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG, &enable, 1);
+
+    // The capture fits in one part
+    test_config_command(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ, offset, sizeof(offset));
+    TEST_ASSERT((p_event = test_last_event(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA)) != NULL);
+    TEST_ASSERT_EQ(p_event->data[2] | (p_event->data[3] << 8), p_event->length - 6);
+
+    for (p = &p_event->data[6], length = p_event->length - 6; length != 0; p += record_len, length -= record_len)
+    {
+        TEST_ASSERT((record_len = hci_decode_capture(p, length, &record)) != 0);
+        if ((record.type == MESH_LIGHT_CTL_CAPTURE_COMMAND) && (record.opcode == HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET))
+        {
+            TEST_ASSERT_EQ(record.length, hdr_len + set_len);
+            TEST_ASSERT(memcmp(record.p_data, command, record.length) == 0);
+            sets++;
+        }
+    }
+    TEST_ASSERT_EQ(sets, 1);
+}
+#endif
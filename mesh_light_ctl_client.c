@@ -41,6 +41,11 @@
 #include "wiced_bt_mesh_models.h"
 #include "wiced_bt_trace.h"
 #include "wiced_bt_mesh_app.h"
+#include "wiced_timer.h"
+#include "wiced_hal_nvram.h"
+#include "wiced_hal_rand.h"
+#include "mesh_light_ctl_codec.h"
+#include "mesh_light_ctl_hci.h"
 
 #ifdef HCI_CONTROL
 #include "wiced_transport.h"
@@ -56,9 +61,326 @@ extern wiced_bt_cfg_settings_t wiced_bt_cfg_settings;
 #define MESH_PID                0x3007
 #define MESH_VID                0x0002
 
+#ifndef MESH_LIGHT_CTL_CLIENT_ELEMENTS
+#define MESH_LIGHT_CTL_CLIENT_ELEMENTS          1       // Number of elements with a Light CTL Client, 1 to 4
+#endif
+
+#ifndef MESH_LIGHT_CTL_CLIENT_CACHE_SIZE
+#define MESH_LIGHT_CTL_CLIENT_CACHE_SIZE        32      // Number of servers for which the last received state is kept
+#endif
+
+// Kinds of state kept in the node cache, one per status message
+#define MESH_LIGHT_CTL_CLIENT_CACHE_CTL         0
+#define MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE 1
+#define MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT     2
+#define MESH_LIGHT_CTL_CLIENT_CACHE_RANGE       3
+#define MESH_LIGHT_CTL_CLIENT_CACHE_KINDS       4
+
+#define MESH_LIGHT_CTL_CLIENT_CACHE_ANY_AGE     0xFFFF  // Maximum age in a get which accepts any cached state, including state restored from NVRAM
+#define MESH_LIGHT_CTL_CLIENT_CACHE_RECORD_LEN  20      // Address, valid kinds, range status, present and default values, range
+#define MESH_LIGHT_CTL_CLIENT_DUMP_ENTRY_LEN    25      // Record, stale kinds and age in seconds
+#define MESH_LIGHT_CTL_CLIENT_DUMP_CHUNK        8       // Entries sent in one HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHE_DUMP
+
+// The cache is saved to NVRAM in blocks of records, one NVRAM item per block and up to 32 blocks
+#ifndef MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL
+#define MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL    30000   // Minimum time in ms between two NVRAM writes, 0 to not keep the cache over a reboot
+#endif
+#define MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS     8       // Cache entries in one block
+#define MESH_LIGHT_CTL_CLIENT_NVRAM_RECORD_LEN  24      // Record followed by its age in seconds
+#define MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS      ((MESH_LIGHT_CTL_CLIENT_CACHE_SIZE + MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS - 1) / MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS)
+#ifndef MESH_LIGHT_CTL_CLIENT_NVRAM_ID
+#define MESH_LIGHT_CTL_CLIENT_NVRAM_ID          WICED_NVRAM_VSID_START  // NVRAM item of the first block, application items count up from the start of the range
+#endif
+#if MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS > 32
+#error "MESH_LIGHT_CTL_CLIENT_CACHE_SIZE needs more NVRAM blocks than bits in the dirty mask"
+#endif
+#define MESH_LIGHT_CTL_CLIENT_NVRAM_MAX_AGE     4000000 // Largest age in seconds restored, tick counts wrap after about 49 days
+
+#define MESH_LIGHT_CTL_CLIENT_IS_UNICAST(addr)  (((addr) != 0) && (((addr) & 0x8000) == 0))
+
+#ifndef MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS
+#define MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS    8       // Number of destinations for which sets can be coalesced at the same time
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_COALESCE_INTERVAL
+#define MESH_LIGHT_CTL_CLIENT_COALESCE_INTERVAL 0       // Default minimum interval in ms between sets to the same destination, 0 to send every set
+#endif
+
+#ifndef MESH_LIGHT_CTL_CLIENT_BATCH_SIZE
+#define MESH_LIGHT_CTL_CLIENT_BATCH_SIZE        240     // Maximum length of the status batch event
+#endif
+#if MESH_LIGHT_CTL_CLIENT_BATCH_SIZE > 255
+#error "MESH_LIGHT_CTL_CLIENT_BATCH_SIZE does not fit the 1 byte length of the events in the batch"
+#endif
+
+#define MESH_LIGHT_CTL_CLIENT_HCI_DATA_LEN      16      // Longest status event data following the event header
+#ifndef MESH_LIGHT_CTL_CLIENT_EVENT_BUDGET
+#define MESH_LIGHT_CTL_CLIENT_EVENT_BUDGET      24      // Number of mesh events the client may hold before commands are refused
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_CREDIT_BATCH
+#define MESH_LIGHT_CTL_CLIENT_CREDIT_BATCH      4       // Credits are granted when at least this many are free or the host has none left
+#endif
+#define MESH_LIGHT_CTL_CLIENT_SEQUENCED_DATA_LEN 256    // Longest event sent in HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SEQUENCED
+
+// Handling of set temperatures outside of the range of the server
+#define MESH_LIGHT_CTL_CLIENT_RANGE_OFF         0       // Send as received
+#define MESH_LIGHT_CTL_CLIENT_RANGE_CLAMP       1       // Clamp to the range
+#define MESH_LIGHT_CTL_CLIENT_RANGE_REJECT      2       // Do not send
+
+#ifndef MESH_LIGHT_CTL_CLIENT_RANGE_MODE
+#define MESH_LIGHT_CTL_CLIENT_RANGE_MODE        MESH_LIGHT_CTL_CLIENT_RANGE_OFF     // Default handling of out of range temperatures
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_RANGE_RETRY_TIME
+#define MESH_LIGHT_CTL_CLIENT_RANGE_RETRY_TIME  60000   // Time in ms before the range of a server which did not reply is requested again
+#endif
+
+#ifndef MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS
+#define MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS      16      // Number of requests which can be in flight or queued
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_REQUEST_WINDOW
+#define MESH_LIGHT_CTL_CLIENT_REQUEST_WINDOW    0       // Default number of requests in flight, 0 to send without tracking
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_REQUEST_TIMEOUT
+#define MESH_LIGHT_CTL_CLIENT_REQUEST_TIMEOUT   3000    // Default time in ms to wait for the status before a retry
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_REQUEST_RETRIES
+#define MESH_LIGHT_CTL_CLIENT_REQUEST_RETRIES   1       // Default number of retries after a timeout
+#endif
+
+#ifndef MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS
+#define MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS     16      // Number of messages which can wait for their send time
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_STAGGER_SLOT_TIME
+#define MESH_LIGHT_CTL_CLIENT_STAGGER_SLOT_TIME 0       // Default time in ms reserved for one status reply, 0 to send without pacing
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_STAGGER_NETWORK_SIZE
+#define MESH_LIGHT_CTL_CLIENT_STAGGER_NETWORK_SIZE 16   // Default number of servers expected to reply to a group message
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_STAGGER_JITTER
+#define MESH_LIGHT_CTL_CLIENT_STAGGER_JITTER    20      // Default maximum random delay in ms added to each paced message
+#endif
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+#ifndef MESH_LIGHT_CTL_CLIENT_LPN_HOLD_TIME
+#define MESH_LIGHT_CTL_CLIENT_LPN_HOLD_TIME     1000    // Maximum time in ms a message waits for the next wake window, 0 to send immediately
+#endif
+#endif
+
+#ifndef MESH_LIGHT_CTL_CLIENT_CURVES
+#define MESH_LIGHT_CTL_CLIENT_CURVES            4       // Number of destinations which can run a daily curve
+#endif
+#ifndef MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAMES
+#define MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAMES   32      // Maximum number of keyframes of a curve
+#endif
+#define MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAME_LEN 6      // Minute of the day, lightness and temperature
+#define MESH_LIGHT_CTL_CLIENT_DAY               86400000    // Length of a day in ms
+#define MESH_LIGHT_CTL_CLIENT_CURVE_MAX_STEP    36000000    // Longest transition sent in one set, 10 hours
+#define MESH_LIGHT_CTL_CLIENT_CURVE_LEAD        1000    // A set is sent up to this many ms early and delayed on the server
+#define MESH_LIGHT_CTL_CLIENT_CURVE_LATE        60000   // A set which is late by up to this many ms is still sent
+
+// State of a request table entry
+#define MESH_LIGHT_CTL_CLIENT_REQUEST_FREE      0
+#define MESH_LIGHT_CTL_CLIENT_REQUEST_QUEUED    1
+#define MESH_LIGHT_CTL_CLIENT_REQUEST_IN_FLIGHT 2
+
+/*
+ * Latency histograms are kept per command, per destination class and per stage. Bucket 0 counts
+ * latencies of 0 ms, bucket n latencies from 2^(n-1) to 2^n - 1 ms, and the last bucket everything above.
+ */
+#define MESH_LIGHT_CTL_CLIENT_NUM_COMMANDS      8       // Light CTL commands defined in hci_control_api.h
+#define MESH_LIGHT_CTL_CLIENT_DST_UNICAST       0
+#define MESH_LIGHT_CTL_CLIENT_DST_GROUP         1       // Group or virtual address
+#define MESH_LIGHT_CTL_CLIENT_NUM_DST_CLASSES   2
+#define MESH_LIGHT_CTL_CLIENT_STAGE_QUEUE       0       // From the HCI command to transmission
+#define MESH_LIGHT_CTL_CLIENT_STAGE_TX          1       // From transmission to TX complete
+#define MESH_LIGHT_CTL_CLIENT_STAGE_RESPONSE    2       // From transmission to the status
+#define MESH_LIGHT_CTL_CLIENT_NUM_STAGES        3
+#define MESH_LIGHT_CTL_CLIENT_LATENCY_BUCKETS   16
+
+// Who started a request and receives its result
+#define MESH_LIGHT_CTL_CLIENT_OWNER_HOST        0       // HCI command, status and completion are sent to the host
+#define MESH_LIGHT_CTL_CLIENT_OWNER_SWEEP       1       // Sweep, status is only used for the sweep result
+#define MESH_LIGHT_CTL_CLIENT_OWNER_INTERNAL    2       // Client, status is only used to update the cache
+
+#ifndef MESH_LIGHT_CTL_CLIENT_SWEEP_MAX_LIST
+#define MESH_LIGHT_CTL_CLIENT_SWEEP_MAX_LIST    64      // Maximum number of addresses in a sweep list
+#endif
+#define MESH_LIGHT_CTL_CLIENT_SWEEP_ENTRY_LEN   7       // Address, two values and flags
+#define MESH_LIGHT_CTL_CLIENT_SWEEP_CHUNK       32      // Results sent in one HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SWEEP_RESULT
+
+/*
+ * Traces on the message receive path, with the trace ids and formats of mesh_light_ctl_hci.h.
+ * With BINARY_TRACE=1 the trace id, tick count and up to 5 arguments are stored in a ring buffer
+ * and formatted later, otherwise they are printed immediately.
+ */
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+#ifndef MESH_LIGHT_CTL_TRACE_RECORDS
+#define MESH_LIGHT_CTL_TRACE_RECORDS            32      // Size of the trace ring buffer, must be a power of 2
+#endif
+#ifndef MESH_LIGHT_CTL_TRACE_DRAIN_INTERVAL
+#define MESH_LIGHT_CTL_TRACE_DRAIN_INTERVAL     500     // Default interval in ms to format stored records, 0 to keep them for HCI read
+#endif
+#define MESH_LIGHT_CTL_TRACE(id, ...) \
+    MESH_LIGHT_CTL_TRACE_PUT(id, __VA_ARGS__, 0, 0, 0, 0, 0)
+#define MESH_LIGHT_CTL_TRACE_PUT(id, a0, a1, a2, a3, a4, ...) \
+    mesh_light_ctl_trace_put(id, (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3), (uint32_t)(a4))
+#else
+#define MESH_LIGHT_CTL_TRACE(id, ...) \
+    WICED_BT_TRACE(id##_FMT, __VA_ARGS__)
+#endif
+
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+#ifndef MESH_LIGHT_CTL_CAPTURE_SIZE
+#define MESH_LIGHT_CTL_CAPTURE_SIZE             2048    // Bytes of HCI traffic kept in the capture, recording stops when it is full
+#endif
+#define MESH_LIGHT_CTL_CAPTURE_CHUNK            200     // Capture bytes sent in one HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA
+#endif
+
 /******************************************************
  *          Structures
  ******************************************************/
+// Last known Light CTL state of a server
+typedef struct
+{
+    uint16_t addr;                                      // Unicast address of the server, 0 if the entry is free
+    uint8_t  valid;                                     // Bit mask of (1 << MESH_LIGHT_CTL_CLIENT_CACHE_xxx) kinds received
+    uint32_t last_used;                                 // Tick count of the last update or lookup, used for replacement
+    uint32_t time[MESH_LIGHT_CTL_CLIENT_CACHE_KINDS];   // Tick count when each kind of status was received
+    wiced_bt_mesh_light_ctl_status_data_t ctl;          // Last CTL Status, delta_uv is not used
+    wiced_bt_mesh_light_ctl_status_data_t temperature;  // Last Temperature Status, lightness is not used
+    wiced_bt_mesh_light_ctl_data_t default_status;
+    uint8_t  range_status;
+    uint16_t range_min;
+    uint16_t range_max;
+    uint32_t range_request_time;                        // Tick count when the range was requested by the client, 0 if never
+    uint8_t  forwarded;                                 // Bit mask of kinds for which forward_hash is valid
+    uint32_t forward_hash[MESH_LIGHT_CTL_CLIENT_CACHE_KINDS];   // Hash of the last status of each kind forwarded to the host
+    uint32_t forward_time[MESH_LIGHT_CTL_CLIENT_CACHE_KINDS];   // Tick count when it was forwarded
+    uint8_t  stale;                                     // Bit mask of kinds restored from NVRAM and not received since
+} mesh_light_ctl_client_node_t;
+
+// Parameters of a Light CTL Client message, the member used depends on the HCI command
+typedef union
+{
+    mesh_light_ctl_codec_get_t                       get;
+    wiced_bt_mesh_light_ctl_set_t                    set;
+    wiced_bt_mesh_light_ctl_temperature_set_t        temperature_set;
+    wiced_bt_mesh_light_ctl_default_data_t           default_set;
+    wiced_bt_mesh_light_ctl_temperature_range_data_t range_set;
+} mesh_light_ctl_client_params_t;
+
+// Handler of a command described in mesh_light_ctl_codec_messages
+typedef void (*mesh_light_ctl_client_command_handler_t)(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+
+// Addressing and delivery parameters needed to create the same event again
+typedef struct
+{
+    uint16_t dst;
+    uint16_t app_key_idx;
+    uint8_t  element_idx;
+    uint8_t  ttl;
+    uint8_t  retrans_cnt;
+    uint8_t  retrans_time;
+    uint8_t  reply;
+    uint8_t  send_segmented;
+    uint32_t reply_timeout;
+} mesh_light_ctl_client_event_hdr_t;
+
+// Set command waiting for the minimum interval since the previous set to the same destination
+typedef struct
+{
+    uint16_t dst;                                       // Destination address
+    uint16_t opcode;                                    // HCI command of the set not sent yet, or of the last set sent, 0 if the slot is free
+    uint32_t sent_time;                                 // Tick count when the last set to dst was sent
+    uint32_t rx_time;                                   // Tick count when the set not sent yet was received
+    wiced_bt_mesh_event_t *p_event;                     // Newest set not sent yet, NULL if none
+    mesh_light_ctl_client_params_t params;
+} mesh_light_ctl_client_coalesce_t;
+
+// Message waiting in the stagger queue for its send time
+typedef struct
+{
+    uint32_t due_time;                                  // Tick count when the message is to be sent
+    uint32_t rx_time;                                   // Tick count when the HCI command was received
+    uint16_t opcode;                                    // HCI command
+    wiced_bt_mesh_event_t *p_event;
+    mesh_light_ctl_client_params_t params;
+} mesh_light_ctl_client_stagger_t;
+
+/*
+ * Message sent to the mesh. Requests which expect a status from a unicast destination while a
+ * window is configured are tracked: queued, retried and reported to the host on completion.
+ * While a window is configured other messages are only kept to measure latency until TX complete
+ * or status. Without a window messages from the host take no entry.
+ */
+typedef struct
+{
+    uint8_t  state;                                     // MESH_LIGHT_CTL_CLIENT_REQUEST_xxx
+    uint8_t  tracked;                                   // Request counts in the window and is reported to the host
+    uint8_t  tx_complete;                               // TX complete has been received
+    uint8_t  owner;                                     // MESH_LIGHT_CTL_CLIENT_OWNER_xxx
+    uint8_t  retries;                                   // Number of retries done
+    uint16_t id;                                        // Identifier reported to the host on completion
+    uint16_t opcode;                                    // HCI command
+    uint16_t status_event;                              // WICED_BT_MESH_LIGHT_CTL_xxx_STATUS which completes the request, 0 for TX complete
+    uint32_t start_time;                                // Tick count when the request was accepted
+    uint32_t sent_time;                                 // Tick count of the last transmission
+    wiced_bt_mesh_event_t *p_event;                     // Event to send while the request is queued
+    wiced_bt_mesh_event_t *p_sent;                      // Event of the last transmission, returned in its TX complete
+    mesh_light_ctl_client_event_hdr_t hdr;              // Used to create a new event for a retry
+    mesh_light_ctl_client_params_t params;
+} mesh_light_ctl_client_request_t;
+
+// Sweep of a list or range of servers
+typedef struct
+{
+    uint8_t  active;
+    uint8_t  kind;                                      // MESH_LIGHT_CTL_CLIENT_CACHE_xxx state to get
+    uint8_t  concurrency;                               // Maximum number of gets in flight
+    uint8_t  in_flight;
+    uint8_t  submitting;                                // Gets are being sent, results do not start new ones
+    uint16_t first;                                     // First address of a range, 0 for a list
+    uint16_t count;                                     // Number of addresses
+    uint16_t next;                                      // Index of the next address to get
+    uint16_t addr[MESH_LIGHT_CTL_CLIENT_SWEEP_MAX_LIST];
+    mesh_light_ctl_client_event_hdr_t hdr;              // Key and delivery parameters from the command
+    uint8_t  num_results;                               // Results not sent to the host yet
+    uint8_t  results[MESH_LIGHT_CTL_CLIENT_SWEEP_CHUNK * MESH_LIGHT_CTL_CLIENT_SWEEP_ENTRY_LEN];
+} mesh_light_ctl_client_sweep_t;
+
+// Point of a daily curve
+typedef struct
+{
+    uint16_t minute;                                    // Minute of the day
+    uint16_t lightness;
+    uint16_t temperature;
+} mesh_light_ctl_client_keyframe_t;
+
+// Daily curve run by the client for a destination
+typedef struct
+{
+    uint16_t dst;                                       // Destination address, 0 if the curve is not used
+    uint8_t  num_keyframes;
+    uint32_t next_ms;                                   // Time of the day in ms when the next transition starts
+    mesh_light_ctl_client_event_hdr_t hdr;              // Key and delivery parameters from the command
+    mesh_light_ctl_client_keyframe_t keyframes[MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAMES];
+} mesh_light_ctl_client_curve_t;
+
+// Buffer for a status event to the host
+typedef struct
+{
+    wiced_bt_mesh_hci_event_t hdr;
+    uint8_t data[MESH_LIGHT_CTL_CLIENT_HCI_DATA_LEN];   // Room for the status data which follows the header
+} mesh_light_ctl_hci_buffer_t;
+
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+// Binary trace record
+typedef struct
+{
+    uint32_t time;                                      // Tick count
+    uint32_t arg[5];
+    uint8_t  id;                                        // MESH_LIGHT_CTL_TRACE_xxx
+} mesh_light_ctl_trace_record_t;
+#endif
 
 /******************************************************
  *          Function Prototypes
@@ -66,18 +388,108 @@ extern wiced_bt_cfg_settings_t wiced_bt_cfg_settings;
 static void mesh_app_init(wiced_bool_t is_provisioned);
 static uint32_t mesh_app_proc_rx_cmd(uint16_t opcode, uint8_t *p_data, uint32_t length);
 static void mesh_light_ctl_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_event, void *p_data);
-static void mesh_light_ctl_client_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_temperature_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_temperature_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_temperature_range_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_temperature_range_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_default_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_client_default_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
-static void mesh_light_ctl_hci_event_send_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_status_data_t *p_data);
-static void mesh_light_ctl_hci_event_send_temperature_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_status_data_t *p_data);
-static void mesh_light_ctl_hci_event_send_default_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_default_data_t *p_data);
-static void mesh_light_ctl_hci_event_send_temperature_range_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_temperature_range_status_data_t *p_data);
+static void mesh_light_ctl_client_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_set_multi_dst(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_set_multi(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_temperature_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_temperature_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_temperature_range_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_temperature_range_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_default_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_default_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params);
+static wiced_bt_mesh_event_t *mesh_light_ctl_client_copy_event(wiced_bt_mesh_event_t *p_event, uint16_t dst);
+static mesh_light_ctl_client_node_t *mesh_light_ctl_client_cache_find(uint16_t addr, wiced_bool_t create);
+static wiced_bool_t mesh_light_ctl_client_cache_has_free(void);
+static void mesh_light_ctl_client_cache_update(uint16_t addr, uint8_t kind, void *p_data);
+static void mesh_light_ctl_client_cache_invalidate(uint16_t addr, uint8_t kind_mask);
+static wiced_bool_t mesh_light_ctl_client_cache_reply(wiced_bt_mesh_event_t *p_event, uint8_t kind, uint16_t max_age);
+static uint8_t *mesh_light_ctl_client_cache_to_stream(uint8_t *p, mesh_light_ctl_client_node_t *p_node);
+static uint16_t mesh_light_ctl_client_cache_temperature(mesh_light_ctl_client_node_t *p_node);
+static uint32_t mesh_light_ctl_client_cache_age(mesh_light_ctl_client_node_t *p_node);
+static void mesh_light_ctl_client_nvram_mark(mesh_light_ctl_client_node_t *p_node);
+static uint16_t mesh_light_ctl_client_nvram_block(uint8_t block, uint8_t *p_buffer, uint32_t *p_hash);
+static void mesh_light_ctl_client_nvram_restore(void);
+static void mesh_light_ctl_client_nvram_erase(void);
+static void mesh_light_ctl_client_nvram_timer_cb(TIMER_PARAM_TYPE arg);
+static void mesh_light_ctl_client_range_config(uint8_t *p_data, uint32_t length);
+static wiced_bool_t mesh_light_ctl_client_range_check(wiced_bt_mesh_event_t *p_event, uint16_t opcode, uint16_t *p_temperature);
+static void mesh_light_ctl_client_curve_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
+static uint8_t mesh_light_ctl_client_curve_simplify(mesh_light_ctl_client_keyframe_t *p_keyframes, uint8_t num, uint16_t tolerance_lightness, uint16_t tolerance_temperature);
+static uint32_t mesh_light_ctl_client_curve_clock(void);
+static void mesh_light_ctl_client_curve_step(mesh_light_ctl_client_curve_t *p_curve, uint16_t delay);
+static void mesh_light_ctl_client_curve_schedule(void);
+static void mesh_light_ctl_client_curve_timer_cb(TIMER_PARAM_TYPE arg);
+static void mesh_light_ctl_client_coalesce_config(uint8_t *p_data, uint32_t length);
+static wiced_bool_t mesh_light_ctl_client_coalesce(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_coalesce_schedule(void);
+static void mesh_light_ctl_client_coalesce_send(mesh_light_ctl_client_coalesce_t *p_slot, uint32_t now);
+static void mesh_light_ctl_client_coalesce_timer_cb(TIMER_PARAM_TYPE arg);
+static void mesh_light_ctl_client_save_event_hdr(mesh_light_ctl_client_event_hdr_t *p_hdr, wiced_bt_mesh_event_t *p_event);
+static wiced_bt_mesh_event_t *mesh_light_ctl_client_create_event(mesh_light_ctl_client_event_hdr_t *p_hdr);
+static void mesh_light_ctl_client_send(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params, uint8_t owner);
+static void mesh_light_ctl_client_stagger_config(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_stagger(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params, wiced_bool_t is_list);
+static void mesh_light_ctl_client_stagger_schedule(void);
+static void mesh_light_ctl_client_stagger_timer_cb(TIMER_PARAM_TYPE arg);
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+static void mesh_light_ctl_client_lpn_sleep(uint32_t max_sleep_duration);
+#ifdef HCI_CONTROL
+static void mesh_light_ctl_client_lpn_stats_get(uint8_t *p_data, uint32_t length);
+#endif
+#endif
+static void mesh_light_ctl_client_transmit(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params);
+static void mesh_light_ctl_client_request_config(uint8_t *p_data, uint32_t length);
+static mesh_light_ctl_client_request_t *mesh_light_ctl_client_request_find(uint16_t src, uint16_t event);
+static void mesh_light_ctl_client_request_status(uint16_t src, uint16_t event);
+static void mesh_light_ctl_client_request_complete(mesh_light_ctl_client_request_t *p_req, uint8_t result);
+static void mesh_light_ctl_client_request_schedule(void);
+static void mesh_light_ctl_client_request_process(void);
+static void mesh_light_ctl_client_request_timer_cb(TIMER_PARAM_TYPE arg);
+static void mesh_light_ctl_client_request_start(mesh_light_ctl_client_request_t *p_req, uint32_t now);
+static void mesh_light_ctl_client_request_tx_complete(wiced_bt_mesh_event_t *p_event);
+static uint8_t mesh_light_ctl_client_command_index(uint16_t opcode);
+static void mesh_light_ctl_client_latency_add(mesh_light_ctl_client_request_t *p_req, uint8_t stage, uint32_t latency);
+#ifdef HCI_CONTROL
+static void mesh_light_ctl_client_latency_get(void);
+#endif
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+static void mesh_light_ctl_trace_put(uint8_t id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4);
+static void mesh_light_ctl_trace_config(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_trace_drain_timer_cb(TIMER_PARAM_TYPE arg);
+#ifdef HCI_CONTROL
+static void mesh_light_ctl_trace_read(void);
+#endif
+#endif
+#ifdef HCI_CONTROL
+static void mesh_light_ctl_hci_event_send_state(wiced_bt_mesh_hci_event_t *p_hci_event, uint8_t message, void *p_data);
+static void mesh_light_ctl_hci_event_send(uint16_t opcode, uint8_t *p_data, uint16_t length);
+static wiced_result_t mesh_light_ctl_hci_transport_send(uint16_t opcode, uint8_t *p_data, uint16_t length);
+static void mesh_light_ctl_client_credit_config(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_credit_update(void);
+static void mesh_light_ctl_hci_batch_config(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_hci_batch_flush(void);
+static void mesh_light_ctl_hci_batch_timer_cb(TIMER_PARAM_TYPE arg);
+static wiced_bt_mesh_hci_event_t *mesh_light_ctl_hci_event_init(wiced_bt_mesh_event_t *p_event);
+static uint8_t mesh_light_ctl_client_events_held(void);
+static uint8_t mesh_light_ctl_client_element_select(void);
+static void mesh_light_ctl_client_command_status(uint16_t opcode, uint8_t status);
+static void mesh_light_ctl_client_filter_config(uint8_t *p_data, uint32_t length);
+static wiced_bool_t mesh_light_ctl_client_filter(uint16_t src, uint16_t event, void *p_data);
+static void mesh_light_ctl_client_filter_expect(uint16_t dst, uint8_t kind);
+static void mesh_light_ctl_client_filter_stats_get(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_pool_stats_get(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_cache_dump(void);
+static void mesh_light_ctl_client_sweep(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_client_sweep_next(void);
+static void mesh_light_ctl_client_sweep_result(uint16_t addr, uint8_t result);
+static void mesh_light_ctl_client_sweep_flush(wiced_bool_t last);
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+static void mesh_light_ctl_capture_put(uint8_t type, uint16_t opcode, uint8_t *p_data, uint16_t length);
+static void mesh_light_ctl_capture_config(uint8_t *p_data, uint32_t length);
+static void mesh_light_ctl_capture_read(uint8_t *p_data, uint32_t length);
+#endif
+#endif
 
 /******************************************************
  *          Variables Definitions
@@ -95,7 +507,34 @@ wiced_bt_mesh_core_config_model_t   mesh_element1_models[] =
 };
 #define MESH_APP_NUM_MODELS  (sizeof(mesh_element1_models) / sizeof(wiced_bt_mesh_core_config_model_t))
 
-#define MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX   0
+#if MESH_LIGHT_CTL_CLIENT_ELEMENTS > 1
+// Each additional element has its own Light CTL Client and publication, for example to control another zone
+static wiced_bt_mesh_core_config_model_t   mesh_client_element_models[] =
+{
+    WICED_BT_MESH_MODEL_LIGHT_CTL_CLIENT,
+};
+#define MESH_CLIENT_ELEMENT_NUM_MODELS  (sizeof(mesh_client_element_models) / sizeof(wiced_bt_mesh_core_config_model_t))
+#endif
+
+#define MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX   0     // First element with a Light CTL Client, others follow it
+
+// Additional element with a Light CTL Client, the values are the same as those of the first element
+#define MESH_LIGHT_CTL_CLIENT_ELEMENT                                                                                                                                                                   \
+    {                                                                                                                                                                                                   \
+        .location = MESH_ELEM_LOC_MAIN,                                 /* location description as defined in the GATT Bluetooth Namespace Descriptors section of the Bluetooth SIG Assigned Numbers */ \
+        .default_transition_time = MESH_DEFAULT_TRANSITION_TIME_IN_MS,  /* Default transition time for models of the element in milliseconds */                                                         \
+        .onpowerup_state = WICED_BT_MESH_ON_POWER_UP_STATE_RESTORE,     /* Default element behavior on power up */                                                                                      \
+        .default_level = 0,                                             /* Default value of the variable controlled on this element */                                                                  \
+        .range_min = 1,                                                 /* Minimum value of the variable controlled on this element */                                                                  \
+        .range_max = 0xffff,                                            /* Maximum value of the variable controlled on this element */                                                                  \
+        .move_rollover = 0,                                             /* If true when level gets to range_max during move operation, it switches to min, otherwise move stops */                      \
+        .properties_num = 0,                                            /* Number of properties in the array models */                                                                                  \
+        .properties = NULL,                                             /* Array of properties in the element */                                                                                        \
+        .sensors_num = 0,                                               /* Number of sensors in the sensor array */                                                                                     \
+        .sensors = NULL,                                                /* Array of sensors of that element */                                                                                          \
+        .models_num = MESH_CLIENT_ELEMENT_NUM_MODELS,                   /* Number of models in the array models */                                                                                      \
+        .models = mesh_client_element_models,                           /* Array of models located in that element, only the Light CTL Client */                                                        \
+    }
 
 wiced_bt_mesh_core_config_element_t mesh_elements[] =
 {
@@ -114,6 +553,15 @@ wiced_bt_mesh_core_config_element_t mesh_elements[] =
         .models_num = MESH_APP_NUM_MODELS,                              // Number of models in the array models
         .models = mesh_element1_models,                                 // Array of models located in that element. Model data is defined by structure wiced_bt_mesh_core_config_model_t
     },
+#if MESH_LIGHT_CTL_CLIENT_ELEMENTS > 1
+    MESH_LIGHT_CTL_CLIENT_ELEMENT,
+#endif
+#if MESH_LIGHT_CTL_CLIENT_ELEMENTS > 2
+    MESH_LIGHT_CTL_CLIENT_ELEMENT,
+#endif
+#if MESH_LIGHT_CTL_CLIENT_ELEMENTS > 3
+    MESH_LIGHT_CTL_CLIENT_ELEMENT,
+#endif
 };
 
 wiced_bt_mesh_core_config_t  mesh_config =
@@ -170,15 +618,150 @@ wiced_bt_mesh_app_func_table_t wiced_bt_mesh_app_func_table =
     NULL,                   // attention processing
     NULL,                   // notify period set
     mesh_app_proc_rx_cmd,   // WICED HCI command
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    mesh_light_ctl_client_lpn_sleep,    // LPN sleep
+#else
     NULL,                   // LPN sleep
+#endif
     NULL                    // factory reset
 };
 
+// Last known state of the Light CTL servers this client talks to
+static mesh_light_ctl_client_node_t mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE];
+
+// Cache blocks are written to NVRAM one at a time, and only if a record other than its age has changed
+static uint32_t mesh_light_ctl_client_nvram_dirty = 0;        // Bit mask of blocks changed since they were saved
+static uint32_t mesh_light_ctl_client_nvram_hash[MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS];    // Hash of the records of each block in NVRAM
+static uint8_t  mesh_light_ctl_client_nvram_next = 0;         // Block checked first by the next write
+static wiced_bool_t mesh_light_ctl_client_nvram_restored = WICED_FALSE;
+static wiced_timer_t mesh_light_ctl_client_nvram_timer;
+
+// MESH_LIGHT_CTL_CLIENT_RANGE_xxx handling of set temperatures outside of the cached server range
+static uint8_t mesh_light_ctl_client_range_mode = MESH_LIGHT_CTL_CLIENT_RANGE_MODE;
+
+// Daily curves and the time of the day, kept from the time given by the host at upload
+static mesh_light_ctl_client_curve_t mesh_light_ctl_client_curves[MESH_LIGHT_CTL_CLIENT_CURVES];
+static uint32_t mesh_light_ctl_client_day_ms = 0;             // Time of the day in ms at day_tick
+static uint32_t mesh_light_ctl_client_day_tick = 0;
+static wiced_timer_t mesh_light_ctl_client_curve_timer;
+
+// Sets to the same destination are merged if they come faster than the interval (ms)
+static mesh_light_ctl_client_coalesce_t mesh_light_ctl_client_coalesce_slots[MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS];
+static uint16_t mesh_light_ctl_client_coalesce_interval = MESH_LIGHT_CTL_CLIENT_COALESCE_INTERVAL;
+static wiced_timer_t mesh_light_ctl_client_coalesce_timer;
+
+// Messages paced so that replies from group members and list destinations do not collide
+static mesh_light_ctl_client_stagger_t mesh_light_ctl_client_stagger_queue[MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS];
+static uint8_t  mesh_light_ctl_client_stagger_head = 0;
+static uint8_t  mesh_light_ctl_client_stagger_count = 0;
+static uint16_t mesh_light_ctl_client_stagger_slot_time = MESH_LIGHT_CTL_CLIENT_STAGGER_SLOT_TIME;
+static uint16_t mesh_light_ctl_client_stagger_network_size = MESH_LIGHT_CTL_CLIENT_STAGGER_NETWORK_SIZE;
+static uint16_t mesh_light_ctl_client_stagger_jitter = MESH_LIGHT_CTL_CLIENT_STAGGER_JITTER;
+static uint32_t mesh_light_ctl_client_stagger_next_time = 0;   // Tick count before which the next paced message is not sent
+static wiced_timer_t mesh_light_ctl_client_stagger_timer;
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+// Messages are held in the stagger queue until the end of the wake window or the next LPN sleep
+static uint16_t mesh_light_ctl_client_lpn_hold_time = MESH_LIGHT_CTL_CLIENT_LPN_HOLD_TIME;
+static wiced_bool_t mesh_light_ctl_client_lpn_holding = WICED_FALSE;
+static uint32_t mesh_light_ctl_client_lpn_window_end = 0;      // Tick count when held messages are sent at the latest
+static uint32_t mesh_light_ctl_client_lpn_commands = 0;        // Messages held for a wake window
+static uint32_t mesh_light_ctl_client_lpn_wakeups = 0;         // Wake windows in which held messages were sent
+static uint32_t mesh_light_ctl_client_lpn_after_poll = 0;      // Wake windows which started right after a friend poll
+#endif
+
+// Requests waiting for status, used to limit the number of requests in flight and to retry
+static mesh_light_ctl_client_request_t mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS];
+static uint8_t  mesh_light_ctl_client_request_window  = MESH_LIGHT_CTL_CLIENT_REQUEST_WINDOW;
+static uint16_t mesh_light_ctl_client_request_timeout = MESH_LIGHT_CTL_CLIENT_REQUEST_TIMEOUT;
+static uint8_t  mesh_light_ctl_client_request_retries = MESH_LIGHT_CTL_CLIENT_REQUEST_RETRIES;
+static uint16_t mesh_light_ctl_client_request_id = 0;
+static wiced_timer_t mesh_light_ctl_client_request_timer;
+static wiced_bool_t mesh_light_ctl_client_request_scheduling = WICED_FALSE;
+static wiced_bool_t mesh_light_ctl_client_request_reschedule = WICED_FALSE;
+
+// Tick count when the HCI command being processed was received, 0 for messages not started by the host
+static uint32_t mesh_light_ctl_client_rx_time = 0;
+
+// Latency histograms, counts stop at 0xFFFF
+static uint16_t mesh_light_ctl_client_latency[MESH_LIGHT_CTL_CLIENT_NUM_COMMANDS][MESH_LIGHT_CTL_CLIENT_NUM_DST_CLASSES][MESH_LIGHT_CTL_CLIENT_NUM_STAGES][MESH_LIGHT_CTL_CLIENT_LATENCY_BUCKETS];
+
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+// Trace ring buffer. Only the writer changes head and only the reader changes tail.
+static mesh_light_ctl_trace_record_t mesh_light_ctl_trace_ring[MESH_LIGHT_CTL_TRACE_RECORDS];
+static volatile uint16_t mesh_light_ctl_trace_head = 0;
+static volatile uint16_t mesh_light_ctl_trace_tail = 0;
+static uint16_t mesh_light_ctl_trace_dropped = 0;              // Records lost because the ring was full
+static uint16_t mesh_light_ctl_trace_drain_interval = MESH_LIGHT_CTL_TRACE_DRAIN_INTERVAL;
+static wiced_timer_t mesh_light_ctl_trace_drain_timer;
+#endif
+
+#if defined(HCI_CONTROL) && defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+// Capture of HCI traffic, a sequence of records which is only cleared when recording starts
+static uint8_t  mesh_light_ctl_capture[MESH_LIGHT_CTL_CAPTURE_SIZE];
+static uint16_t mesh_light_ctl_capture_len = 0;
+static uint16_t mesh_light_ctl_capture_dropped = 0;            // Records which did not fit
+static uint32_t mesh_light_ctl_capture_time = 0;               // Tick count of the last record
+static wiced_bool_t mesh_light_ctl_capture_enabled = WICED_FALSE;
+#endif
+
+#ifdef HCI_CONTROL
+// Commands with a fixed layout, decoded before the handler is called
+static const mesh_light_ctl_client_command_handler_t mesh_light_ctl_client_command_handlers[MESH_LIGHT_CTL_CODEC_NUM_COMMANDS] =
+{
+    [MESH_LIGHT_CTL_CODEC_GET]                   = mesh_light_ctl_client_get,
+    [MESH_LIGHT_CTL_CODEC_SET]                   = mesh_light_ctl_client_set,
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET]       = mesh_light_ctl_client_temperature_get,
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET]       = mesh_light_ctl_client_temperature_set,
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_GET] = mesh_light_ctl_client_temperature_range_get,
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_SET] = mesh_light_ctl_client_temperature_range_set,
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_GET]           = mesh_light_ctl_client_default_get,
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_SET]           = mesh_light_ctl_client_default_set,
+};
+
+// Status events waiting to be sent to the host in one HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH
+static uint8_t mesh_light_ctl_hci_batch[MESH_LIGHT_CTL_CLIENT_BATCH_SIZE];
+static uint16_t mesh_light_ctl_hci_batch_len = 0;
+static uint16_t mesh_light_ctl_hci_batch_flush_time = 0;       // Maximum time in ms a status waits in the batch, 0 if batching is disabled
+static wiced_timer_t mesh_light_ctl_hci_batch_timer;
+
+// Status event buffer and usage statistics. The transport copies an event when it is sent, so a
+// status is built and sent before the mesh callback returns and one buffer is enough.
+static mesh_light_ctl_hci_buffer_t mesh_light_ctl_hci_status;
+static uint32_t mesh_light_ctl_hci_statuses = 0;               // Status events sent or batched for the host
+static uint16_t mesh_light_ctl_hci_batch_high_water = 0;       // Longest batch in bytes
+static uint16_t mesh_light_ctl_hci_send_failures = 0;          // Events the transport did not accept
+
+// Mesh events held by the client in its queues and the commands refused because of it
+static uint8_t  mesh_light_ctl_client_events_high_water = 0;
+static uint16_t mesh_light_ctl_client_events_refused = 0;
+static uint16_t mesh_light_ctl_client_event_failures = 0;      // Mesh event could not be created from the command
+
+static uint8_t  mesh_light_ctl_client_element_next = 0;        // Client element tried first when the client chooses the element
+
+// Credit flow control, each command with a mesh header uses one credit
+static wiced_bool_t mesh_light_ctl_client_credit_enabled = WICED_FALSE;
+static uint8_t  mesh_light_ctl_client_credits = 0;             // Credits granted and not used by the host
+static uint16_t mesh_light_ctl_client_credit_overruns = 0;     // Commands received when the host had no credit
+static uint8_t  mesh_light_ctl_client_tx_pending = 0;          // Messages handed to the mesh core and waiting for TX complete
+static uint16_t mesh_light_ctl_hci_seq = 0;                    // Sequence number of the next event to the host
+static uint8_t  mesh_light_ctl_hci_sequenced[4 + MESH_LIGHT_CTL_CLIENT_SEQUENCED_DATA_LEN];
+
+static mesh_light_ctl_client_sweep_t mesh_light_ctl_client_sweep_state;
+
+// Change only forwarding of statuses which were not requested by the host
+static wiced_bool_t mesh_light_ctl_client_filter_enabled = WICED_FALSE;
+static uint16_t mesh_light_ctl_client_filter_heartbeat = 0;   // Seconds after which an unchanged status is forwarded again, 0 for never
+static uint32_t mesh_light_ctl_client_filter_suppressed = 0;
+#endif
+
 /******************************************************
  *               Function Definitions
  ******************************************************/
 void mesh_app_init(wiced_bool_t is_provisioned)
 {
+    uint8_t element;
+
     wiced_bt_cfg_settings.device_name = (uint8_t *)"CTL Control";
     wiced_bt_cfg_settings.gatt_cfg.appearance = APPEARANCE_CONTROL_DEVICE_TOUCH_PANEL;
     // Adv Data is fixed. Spec allows to put URI, Name, Appearance and Tx Power in the Scan Response Data.
@@ -202,7 +785,28 @@ void mesh_app_init(wiced_bool_t is_provisioned)
         wiced_bt_mesh_set_raw_scan_response_data(num_elem, adv_elem);
     }
 
-    wiced_bt_mesh_model_light_ctl_client_init(MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX, mesh_light_ctl_client_message_handler, is_provisioned);
+    wiced_init_timer(&mesh_light_ctl_client_coalesce_timer, mesh_light_ctl_client_coalesce_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+    wiced_init_timer(&mesh_light_ctl_client_curve_timer, mesh_light_ctl_client_curve_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+    wiced_init_timer(&mesh_light_ctl_client_stagger_timer, mesh_light_ctl_client_stagger_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+    wiced_init_timer(&mesh_light_ctl_client_request_timer, mesh_light_ctl_client_request_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+    wiced_init_timer(&mesh_light_ctl_client_nvram_timer, mesh_light_ctl_client_nvram_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+    wiced_init_timer(&mesh_light_ctl_trace_drain_timer, mesh_light_ctl_trace_drain_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+    if (mesh_light_ctl_trace_drain_interval != 0)
+        wiced_start_timer(&mesh_light_ctl_trace_drain_timer, mesh_light_ctl_trace_drain_interval);
+#endif
+#ifdef HCI_CONTROL
+    wiced_init_timer(&mesh_light_ctl_hci_batch_timer, mesh_light_ctl_hci_batch_timer_cb, 0, WICED_MILLI_SECONDS_TIMER);
+#endif
+
+    // State saved before the reboot belongs to the network the node is provisioned to
+    if (is_provisioned)
+        mesh_light_ctl_client_nvram_restore();
+    else
+        mesh_light_ctl_client_nvram_erase();
+
+    for (element = 0; element < MESH_LIGHT_CTL_CLIENT_ELEMENTS; element++)
+        wiced_bt_mesh_model_light_ctl_client_init(MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX + element, mesh_light_ctl_client_message_handler, is_provisioned);
 }
 
 /*
@@ -212,70 +816,108 @@ void mesh_light_ctl_client_message_handler(uint16_t event, wiced_bt_mesh_event_t
 {
 #if defined HCI_CONTROL
     wiced_bt_mesh_hci_event_t *p_hci_event;
+    mesh_light_ctl_client_request_t *p_req;
+    wiced_bool_t forward = WICED_TRUE;
 #endif
     wiced_bt_mesh_light_ctl_status_data_t *p_status;
     wiced_bt_mesh_light_ctl_temperature_range_status_data_t *p_temperature_range_status;
     wiced_bt_mesh_light_ctl_default_data_t *p_default_status;
+#if defined(HCI_CONTROL) && defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+    uint8_t src[2];
+#endif
+
+    MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_MSG, event);
+
+#if defined(HCI_CONTROL) && defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+    src[0] = (uint8_t)p_event->src;
+    src[1] = (uint8_t)(p_event->src >> 8);
+    mesh_light_ctl_capture_put(MESH_LIGHT_CTL_CAPTURE_MESH, event, src, sizeof(src));
+#endif
 
-    WICED_BT_TRACE("pwr lvl clt msg:%d\n", event);
+#if defined HCI_CONTROL
+    // Statuses requested by the client itself are not sent to the host, and statuses nobody
+    // requested only if they changed
+    if (event != WICED_BT_MESH_TX_COMPLETE)
+    {
+        if ((p_req = mesh_light_ctl_client_request_find(p_event->src, event)) != NULL)
+            forward = (p_req->owner == MESH_LIGHT_CTL_CLIENT_OWNER_HOST);
+        else
+            forward = mesh_light_ctl_client_filter(p_event->src, event, p_data);
+    }
+#endif
 
     switch (event)
     {
     case WICED_BT_MESH_TX_COMPLETE:
-        WICED_BT_TRACE("tx complete status:%d\n", p_event->status.tx_flag);
+        MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_TX_COMPLETE, p_event->status.tx_flag);
+        mesh_light_ctl_client_request_tx_complete(p_event);
 #if defined HCI_CONTROL
+        if (mesh_light_ctl_client_tx_pending != 0)
+            mesh_light_ctl_client_tx_pending--;
+        // Statuses received before the TX complete are delivered first
+        mesh_light_ctl_hci_batch_flush();
         if ((p_hci_event = wiced_bt_mesh_create_hci_event(p_event)) != NULL)
             wiced_bt_mesh_send_hci_tx_complete(p_hci_event, p_event);
+        // Message left the client, its event may be available for another command
+        mesh_light_ctl_client_credit_update();
 #endif
         break;
 
     case WICED_BT_MESH_LIGHT_CTL_STATUS:
         p_status = (wiced_bt_mesh_light_ctl_status_data_t *)p_data;
-        WICED_BT_TRACE("light status light/temp present:%d/%d target:%d/%d remain time:%d\n",
+        MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_STATUS,
                 p_status->present.lightness, p_status->present.temperature,
                 p_status->target.lightness, p_status->target.temperature, p_status->remaining_time);
+        mesh_light_ctl_client_cache_update(p_event->src, MESH_LIGHT_CTL_CLIENT_CACHE_CTL, p_status);
 #if defined HCI_CONTROL
-        if ((p_hci_event = wiced_bt_mesh_create_hci_event(p_event)) != NULL)
-            mesh_light_ctl_hci_event_send_status(p_hci_event, p_status);
+        if (forward)
+            mesh_light_ctl_hci_event_send_state(mesh_light_ctl_hci_event_init(p_event), MESH_LIGHT_CTL_CODEC_STATUS, p_status);
 #endif
         break;
 
     case WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS:
         p_default_status = (wiced_bt_mesh_light_ctl_default_data_t *)p_data;
-        WICED_BT_TRACE("default lightness:%d temp:%d uv:%d\n",
+        MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS,
                 p_default_status->default_status.lightness, p_default_status->default_status.temperature,
                 p_default_status->default_status.delta_uv);
+        mesh_light_ctl_client_cache_update(p_event->src, MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT, p_default_status);
 #if defined HCI_CONTROL
-        if ((p_hci_event = wiced_bt_mesh_create_hci_event(p_event)) != NULL)
-            mesh_light_ctl_hci_event_send_default_status(p_hci_event, p_default_status);
+        if (forward)
+            mesh_light_ctl_hci_event_send_state(mesh_light_ctl_hci_event_init(p_event), MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS, p_default_status);
 #endif
         break;
 
     case WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS:
         p_status = (wiced_bt_mesh_light_ctl_status_data_t *)p_data;
-        WICED_BT_TRACE("temp status: temp/UV present %d/%d target:%d/%d time:%d\n",
+        MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS,
                 p_status->present.temperature, p_status->present.delta_uv,
                 p_status->target.temperature, p_status->target.delta_uv,
                 p_status->remaining_time);
+        mesh_light_ctl_client_cache_update(p_event->src, MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE, p_status);
 #if defined HCI_CONTROL
-        if ((p_hci_event = wiced_bt_mesh_create_hci_event(p_event)) != NULL)
-            mesh_light_ctl_hci_event_send_temperature_status(p_hci_event, p_status);
+        if (forward)
+            mesh_light_ctl_hci_event_send_state(mesh_light_ctl_hci_event_init(p_event), MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS, p_status);
 #endif
         break;
 
     case WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS:
         p_temperature_range_status = (wiced_bt_mesh_light_ctl_temperature_range_status_data_t *)p_data;
-        WICED_BT_TRACE("temp range status: status %d min/max:%d/%d\n", p_temperature_range_status->status,
+        MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_RANGE_STATUS, p_temperature_range_status->status,
                 p_temperature_range_status->min_level, p_temperature_range_status->max_level);
+        mesh_light_ctl_client_cache_update(p_event->src, MESH_LIGHT_CTL_CLIENT_CACHE_RANGE, p_temperature_range_status);
 #if defined HCI_CONTROL
-        if ((p_hci_event = wiced_bt_mesh_create_hci_event(p_event)) != NULL)
-            mesh_light_ctl_hci_event_send_temperature_range_status(p_hci_event, p_temperature_range_status);
+        if (forward)
+            mesh_light_ctl_hci_event_send_state(mesh_light_ctl_hci_event_init(p_event), MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS, p_temperature_range_status);
 #endif
         break;
 
     default:
         break;
     }
+    // Complete the request waiting for this status, if any, after the status is reported
+    if (event != WICED_BT_MESH_TX_COMPLETE)
+        mesh_light_ctl_client_request_status(p_event->src, event);
+
     wiced_bt_mesh_release_event(p_event);
 }
 
@@ -287,215 +929,2908 @@ uint32_t mesh_app_proc_rx_cmd(uint16_t opcode, uint8_t *p_data, uint32_t length)
 {
 #ifdef HCI_CONTROL
     wiced_bt_mesh_event_t *p_event;
+    mesh_light_ctl_client_params_t params;
+    const mesh_light_ctl_codec_message_t *p_msg = mesh_light_ctl_codec_find_command(opcode);
+    uint32_t rx_time = wiced_bt_mesh_core_get_tick_count();
+    wiced_bool_t element_any;
 
-    switch (opcode)
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+    mesh_light_ctl_capture_put(MESH_LIGHT_CTL_CAPTURE_COMMAND, opcode, p_data, (uint16_t)length);
+#endif
+
+    // Commands described by the codec have a mesh header, others are listed here
+    if (p_msg == NULL)
     {
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET:
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET:
-        break;
+        switch (opcode)
+        {
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST:
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI:
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP:
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET:
+            break;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_COALESCE_CONFIG:
+            mesh_light_ctl_client_coalesce_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG:
+            mesh_light_ctl_client_range_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_CONFIG:
+            mesh_light_ctl_client_filter_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_STATS_GET:
+            mesh_light_ctl_client_filter_stats_get(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG:
+            mesh_light_ctl_hci_batch_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG:
+            mesh_light_ctl_client_request_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG:
+            mesh_light_ctl_client_stagger_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_POOL_STATS_GET:
+            mesh_light_ctl_client_pool_stats_get(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CACHE_DUMP:
+            mesh_light_ctl_client_cache_dump();
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CREDIT_CONFIG:
+            mesh_light_ctl_client_credit_config(p_data, length);
+            return WICED_TRUE;
 
-    default:
-        return WICED_FALSE;
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LPN_STATS_GET:
+            mesh_light_ctl_client_lpn_stats_get(p_data, length);
+            return WICED_TRUE;
+#endif
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LATENCY_GET:
+            mesh_light_ctl_client_latency_get();
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LATENCY_RESET:
+            memset(mesh_light_ctl_client_latency, 0, sizeof(mesh_light_ctl_client_latency));
+            return WICED_TRUE;
+
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_CONFIG:
+            mesh_light_ctl_trace_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_READ:
+            mesh_light_ctl_trace_read();
+            return WICED_TRUE;
+#endif
+
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG:
+            mesh_light_ctl_capture_config(p_data, length);
+            return WICED_TRUE;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ:
+            mesh_light_ctl_capture_read(p_data, length);
+            return WICED_TRUE;
+#endif
+
+        default:
+            return WICED_FALSE;
+        }
+    }
+    if (mesh_light_ctl_client_credit_enabled)
+    {
+        if (mesh_light_ctl_client_credits != 0)
+            mesh_light_ctl_client_credits--;
+        else
+            mesh_light_ctl_client_credit_overruns++;
     }
+    // Refuse the command rather than letting queued messages use up the mesh events
+    if (mesh_light_ctl_client_events_held() >= MESH_LIGHT_CTL_CLIENT_EVENT_BUDGET)
+    {
+        mesh_light_ctl_client_events_refused++;
+        mesh_light_ctl_client_command_status(opcode, MESH_LIGHT_CTL_CLIENT_COMMAND_NO_BUDGET);
+        mesh_light_ctl_client_credit_update();
+        return WICED_TRUE;
+    }
+    // Header starts with destination (2 bytes), application key index (2 bytes) and element index (1 byte)
+    element_any = (length > 4) && (p_data[4] == MESH_LIGHT_CTL_CLIENT_ELEMENT_ANY);
+
     p_event = wiced_bt_mesh_create_event_from_wiced_hci(opcode, MESH_COMPANY_ID_BT_SIG, WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT, &p_data, &length);
     if (p_event == NULL)
     {
         WICED_BT_TRACE("ctl bad hdr\n");
+        mesh_light_ctl_client_event_failures++;
+        mesh_light_ctl_client_command_status(opcode, MESH_LIGHT_CTL_CLIENT_COMMAND_NO_EVENT);
+        mesh_light_ctl_client_credit_update();
         return WICED_TRUE;
     }
-    switch (opcode)
+    // Publications use the first client element, other messages the least busy one
+    if (element_any)
+        p_event->element_idx = (p_event->dst == 0) ? MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX : mesh_light_ctl_client_element_select();
+    mesh_light_ctl_client_rx_time = rx_time;
+
+    if (p_msg != NULL)
     {
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET:
-        mesh_light_ctl_client_get(p_event, p_data, length);
-        break;
+        memset(&params, 0, sizeof(params));
+        if (mesh_light_ctl_codec_decode(p_msg, p_data, length, &params) == MESH_LIGHT_CTL_CODEC_ERROR)
+        {
+            WICED_BT_TRACE("ctl bad len opcode:%04x len:%d\n", opcode, length);
+            wiced_bt_mesh_release_event(p_event);
+            mesh_light_ctl_client_command_status(opcode, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+        }
+        else
+        {
+            mesh_light_ctl_client_command_handlers[p_msg - mesh_light_ctl_codec_messages](p_event, &params);
+        }
+    }
+    else
+    {
+        switch (opcode)
+        {
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST:
+            mesh_light_ctl_client_set_multi_dst(p_event, p_data, length);
+            break;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI:
+            mesh_light_ctl_client_set_multi(p_event, p_data, length);
+            break;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP:
+            mesh_light_ctl_client_sweep(p_event, p_data, length);
+            break;
+
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET:
+            mesh_light_ctl_client_curve_set(p_event, p_data, length);
+            break;
+        }
+    }
+    mesh_light_ctl_client_rx_time = 0;
+    mesh_light_ctl_client_credit_update();
+#endif
+    return WICED_TRUE;
+}
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET:
-        mesh_light_ctl_client_set(p_event, p_data, length);
-        break;
+/*
+ * Send Light CTL get command
+ */
+void mesh_light_ctl_client_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
+{
+    if (mesh_light_ctl_client_cache_reply(p_event, MESH_LIGHT_CTL_CLIENT_CACHE_CTL, p_params->get.max_age))
+        return;
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET:
-        mesh_light_ctl_client_temperature_get(p_event, p_data, length);
-        break;
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, NULL, WICED_FALSE);
+}
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET:
-        mesh_light_ctl_client_temperature_set(p_event, p_data, length);
-        break;
+/*
+ * Send Light CTL set command
+ */
+void mesh_light_ctl_client_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
+{
+    if (!mesh_light_ctl_client_range_check(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, &p_params->set.target.temperature))
+        return;
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET:
-        mesh_light_ctl_client_temperature_range_get(p_event, p_data, length);
-        break;
+    mesh_light_ctl_client_cache_invalidate(p_event->dst, (1 << MESH_LIGHT_CTL_CLIENT_CACHE_CTL) | (1 << MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE));
+    if (mesh_light_ctl_client_coalesce(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, p_params))
+        return;
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET:
-        mesh_light_ctl_client_temperature_range_set(p_event, p_data, length);
-        break;
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, p_params, WICED_FALSE);
+}
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET:
-        mesh_light_ctl_client_default_get(p_event, p_data, length);
-        break;
+/*
+ * Send the same Light CTL set command to each destination in the list.
+ * Data: lightness, temperature, delta_uv, transition time, delay, number of destinations, destinations.
+ * The destination in the command header is not used.
+ */
+void mesh_light_ctl_client_set_multi_dst(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+{
+    const mesh_light_ctl_codec_message_t *p_set_msg = &mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_SET];
+    mesh_light_ctl_client_params_t params;
+    wiced_bt_mesh_event_t *p_dst_event;
+    uint16_t set_len = mesh_light_ctl_codec_length(p_set_msg, WICED_TRUE);
+    uint16_t decoded;
+    uint8_t num_dst;
+    uint16_t dst;
+
+    if ((length < set_len + 1U) || (p_data[set_len] == 0) || (length < set_len + 1U + 2 * (uint32_t)p_data[set_len]))
+    {
+        WICED_BT_TRACE("ctl set multi dst bad len:%d\n", length);
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+    if ((decoded = mesh_light_ctl_codec_decode(p_set_msg, p_data, set_len, &params.set)) == MESH_LIGHT_CTL_CODEC_ERROR)
+    {
+        WICED_BT_TRACE("ctl set multi dst bad set\n");
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+    p_data += decoded;
+    STREAM_TO_UINT8(num_dst, p_data);
 
-    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET:
-        mesh_light_ctl_client_default_set(p_event, p_data, length);
-        break;
+    // The event created from the command header is used for the last destination, all others get a copy
+    while (num_dst-- != 0)
+    {
+        STREAM_TO_UINT16(dst, p_data);
+        mesh_light_ctl_client_cache_invalidate(dst, (1 << MESH_LIGHT_CTL_CLIENT_CACHE_CTL) | (1 << MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE));
+        if (num_dst == 0)
+        {
+            p_event->dst = dst;
+            mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, &params, WICED_TRUE);
+            break;
+        }
+        if ((p_dst_event = mesh_light_ctl_client_copy_event(p_event, dst)) == NULL)
+        {
+            WICED_BT_TRACE("ctl set multi no event dst:%04x left:%d\n", dst, num_dst + 1);
+            wiced_bt_mesh_release_event(p_event);
+            break;
+        }
+        mesh_light_ctl_client_stagger(p_dst_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, &params, WICED_TRUE);
+    }
 }
+
+/*
+ * Send Light CTL set command with its own value to each destination in the list.
+ * Data: number of entries followed by entries of destination, lightness, temperature, delta_uv, transition time and delay.
+ * The destination in the command header is not used.
+ */
+void mesh_light_ctl_client_set_multi(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+{
+    const mesh_light_ctl_codec_message_t *p_set_msg = &mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_SET];
+    mesh_light_ctl_client_params_t params;
+    wiced_bt_mesh_event_t *p_dst_event;
+    uint16_t set_len = mesh_light_ctl_codec_length(p_set_msg, WICED_TRUE);
+    uint16_t decoded;
+    uint8_t num_dst;
+    uint16_t dst;
+
+    if ((length < 1) || (p_data[0] == 0) || (length < 1 + (2U + set_len) * (uint32_t)p_data[0]))
+    {
+        WICED_BT_TRACE("ctl set multi bad len:%d\n", length);
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
 #endif
-    return WICED_TRUE;
+        return;
+    }
+    STREAM_TO_UINT8(num_dst, p_data);
+
+    while (num_dst-- != 0)
+    {
+        STREAM_TO_UINT16(dst, p_data);
+        if ((decoded = mesh_light_ctl_codec_decode(p_set_msg, p_data, set_len, &params.set)) == MESH_LIGHT_CTL_CODEC_ERROR)
+        {
+            WICED_BT_TRACE("ctl set multi bad set dst:%04x left:%d\n", dst, num_dst + 1);
+            wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+            mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+            break;
+        }
+        p_data += decoded;
+        mesh_light_ctl_client_cache_invalidate(dst, (1 << MESH_LIGHT_CTL_CLIENT_CACHE_CTL) | (1 << MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE));
+        if (num_dst == 0)
+        {
+            p_event->dst = dst;
+            mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, &params, WICED_TRUE);
+            break;
+        }
+        if ((p_dst_event = mesh_light_ctl_client_copy_event(p_event, dst)) == NULL)
+        {
+            WICED_BT_TRACE("ctl set multi no event dst:%04x left:%d\n", dst, num_dst + 1);
+            wiced_bt_mesh_release_event(p_event);
+            break;
+        }
+        mesh_light_ctl_client_stagger(p_dst_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, &params, WICED_TRUE);
+    }
 }
 
 /*
- * Send Light CTL get command
+ * Create a new event for the Light CTL Client model addressed to dst, with the
+ * same key, element and delivery parameters as p_event.
  */
-void mesh_light_ctl_client_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+wiced_bt_mesh_event_t *mesh_light_ctl_client_copy_event(wiced_bt_mesh_event_t *p_event, uint16_t dst)
 {
-    wiced_bt_mesh_model_light_ctl_client_send_get(p_event);
+    mesh_light_ctl_client_event_hdr_t hdr;
+
+    mesh_light_ctl_client_save_event_hdr(&hdr, p_event);
+    hdr.dst = dst;
+    return mesh_light_ctl_client_create_event(&hdr);
 }
 
 /*
- * Send Light CTL set command
+ * Save addressing and delivery parameters of an event
  */
-void mesh_light_ctl_client_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_save_event_hdr(mesh_light_ctl_client_event_hdr_t *p_hdr, wiced_bt_mesh_event_t *p_event)
 {
-    wiced_bt_mesh_light_ctl_set_t set_data;
+    p_hdr->dst            = p_event->dst;
+    p_hdr->app_key_idx    = p_event->app_key_idx;
+    p_hdr->element_idx    = p_event->element_idx;
+    p_hdr->ttl            = p_event->ttl;
+    p_hdr->retrans_cnt    = p_event->retrans_cnt;
+    p_hdr->retrans_time   = p_event->retrans_time;
+    p_hdr->reply          = p_event->reply;
+    p_hdr->send_segmented = p_event->send_segmented;
+    p_hdr->reply_timeout  = p_event->reply_timeout;
+}
 
-    STREAM_TO_UINT16(set_data.target.lightness, p_data);
-    STREAM_TO_UINT16(set_data.target.temperature, p_data);
-    STREAM_TO_UINT16(set_data.target.delta_uv, p_data);
-    STREAM_TO_UINT32(set_data.transition_time, p_data);
-    STREAM_TO_UINT16(set_data.delay, p_data);
+/*
+ * Create a Light CTL Client event from saved parameters
+ */
+wiced_bt_mesh_event_t *mesh_light_ctl_client_create_event(mesh_light_ctl_client_event_hdr_t *p_hdr)
+{
+    wiced_bt_mesh_event_t *p_event;
 
-    wiced_bt_mesh_model_light_ctl_client_send_set(p_event, &set_data);
+    p_event = wiced_bt_mesh_create_event(p_hdr->element_idx, MESH_COMPANY_ID_BT_SIG, WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT, p_hdr->dst, p_hdr->app_key_idx);
+    if (p_event != NULL)
+    {
+        p_event->ttl            = p_hdr->ttl;
+        p_event->retrans_cnt    = p_hdr->retrans_cnt;
+        p_event->retrans_time   = p_hdr->retrans_time;
+        p_event->reply          = p_hdr->reply;
+        p_event->send_segmented = p_hdr->send_segmented;
+        p_event->reply_timeout  = p_hdr->reply_timeout;
+    }
+    return p_event;
 }
 
 /*
  * Send Light CTL Temperature get command
  */
-void mesh_light_ctl_client_temperature_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_temperature_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
 {
-    wiced_bt_mesh_model_light_ctl_client_send_temperature_get(p_event);
+    if (mesh_light_ctl_client_cache_reply(p_event, MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE, p_params->get.max_age))
+        return;
+
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET, NULL, WICED_FALSE);
 }
 
 /*
  * Send Light CTL Temperature set command
  */
-void mesh_light_ctl_client_temperature_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_temperature_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
 {
-    wiced_bt_mesh_light_ctl_temperature_set_t set_data;
+    if (!mesh_light_ctl_client_range_check(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET, &p_params->temperature_set.target_temperature))
+        return;
 
-    STREAM_TO_UINT16(set_data.target_temperature, p_data);
-    STREAM_TO_UINT16(set_data.target_delta_uv, p_data);
-    STREAM_TO_UINT32(set_data.transition_time, p_data);
-    STREAM_TO_UINT16(set_data.delay, p_data);
+    mesh_light_ctl_client_cache_invalidate(p_event->dst, (1 << MESH_LIGHT_CTL_CLIENT_CACHE_CTL) | (1 << MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE));
+    if (mesh_light_ctl_client_coalesce(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET, p_params))
+        return;
 
-    wiced_bt_mesh_model_light_ctl_client_send_temperature_set(p_event, &set_data);
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET, p_params, WICED_FALSE);
 }
 
 /*
  * Send Light CTL Get Default command
  */
-void mesh_light_ctl_client_default_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_default_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
 {
-    wiced_bt_mesh_model_light_ctl_client_send_default_get(p_event);
+    if (mesh_light_ctl_client_cache_reply(p_event, MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT, p_params->get.max_age))
+        return;
+
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET, NULL, WICED_FALSE);
 }
 
 /*
  * Send power Light CTL Set Default command
  */
-void mesh_light_ctl_client_default_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_default_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
 {
-    wiced_bt_mesh_light_ctl_default_data_t set_data;
-
-    STREAM_TO_UINT16(set_data.default_status.lightness, p_data);
-    STREAM_TO_UINT16(set_data.default_status.temperature, p_data);
-    STREAM_TO_UINT16(set_data.default_status.delta_uv, p_data);
-
-    wiced_bt_mesh_model_light_ctl_client_send_default_set(p_event, &set_data);
+    mesh_light_ctl_client_cache_invalidate(p_event->dst, 1 << MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT);
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET, p_params, WICED_FALSE);
 }
 
 /*
  * Send Light CTL Temperature Range Get command
  */
-void mesh_light_ctl_client_temperature_range_get(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_temperature_range_get(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
 {
-    wiced_bt_mesh_model_light_ctl_client_send_temperature_range_get(p_event);
+    if (mesh_light_ctl_client_cache_reply(p_event, MESH_LIGHT_CTL_CLIENT_CACHE_RANGE, p_params->get.max_age))
+        return;
+
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET, NULL, WICED_FALSE);
 }
 
 /*
  * Send Light CTL Temperature Range Set command
  */
-void mesh_light_ctl_client_temperature_range_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+void mesh_light_ctl_client_temperature_range_set(wiced_bt_mesh_event_t *p_event, mesh_light_ctl_client_params_t *p_params)
 {
-    wiced_bt_mesh_light_ctl_temperature_range_data_t set_data;
-
-    STREAM_TO_UINT16(set_data.min_level, p_data);
-    STREAM_TO_UINT16(set_data.max_level, p_data);
-
-    wiced_bt_mesh_model_light_ctl_client_send_temperature_range_set(p_event, &set_data);
+    mesh_light_ctl_client_cache_invalidate(p_event->dst, 1 << MESH_LIGHT_CTL_CLIENT_CACHE_RANGE);
+    mesh_light_ctl_client_stagger(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET, p_params, WICED_FALSE);
 }
 
-#ifdef HCI_CONTROL
 /*
- * Send Power Level Status event over transport
+ * Find the cache entry of a server. If create is set and the server is not known, a free
+ * or the least recently used entry is assigned to it.
  */
-void mesh_light_ctl_hci_event_send_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_status_data_t *p_data)
+mesh_light_ctl_client_node_t *mesh_light_ctl_client_cache_find(uint16_t addr, wiced_bool_t create)
 {
-    uint8_t *p = p_hci_event->data;
+    mesh_light_ctl_client_node_t *p_node;
+    mesh_light_ctl_client_node_t *p_oldest = NULL;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
 
-    UINT16_TO_STREAM(p, p_data->present.lightness);
-    UINT16_TO_STREAM(p, p_data->present.temperature);
-    UINT16_TO_STREAM(p, p_data->target.lightness);
-    UINT16_TO_STREAM(p, p_data->target.temperature);
-    UINT32_TO_STREAM(p, p_data->remaining_time);
+    if (!MESH_LIGHT_CTL_CLIENT_IS_UNICAST(addr))
+        return NULL;
 
-    mesh_transport_send_data(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS, (uint8_t *)p_hci_event, (uint16_t)(p - (uint8_t *)p_hci_event));
+    for (p_node = mesh_light_ctl_client_cache; p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]; p_node++)
+    {
+        if (p_node->addr == addr)
+        {
+            p_node->last_used = now;
+            return p_node;
+        }
+        if (p_node->addr == 0)
+        {
+            if ((p_oldest == NULL) || (p_oldest->addr != 0))
+                p_oldest = p_node;
+        }
+        else if ((p_oldest == NULL) || ((p_oldest->addr != 0) && ((now - p_node->last_used) > (now - p_oldest->last_used))))
+        {
+            p_oldest = p_node;
+        }
+    }
+    if (!create)
+        return NULL;
+
+    memset(p_oldest, 0, sizeof(*p_oldest));
+    p_oldest->addr      = addr;
+    p_oldest->last_used = now;
+    mesh_light_ctl_client_nvram_mark(p_oldest);
+    return p_oldest;
 }
 
 /*
- * Send Light CTL Temperature Status event over transport
+ * Check if a cache entry is not assigned to any server
  */
-void mesh_light_ctl_hci_event_send_temperature_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_status_data_t *p_data)
+wiced_bool_t mesh_light_ctl_client_cache_has_free(void)
 {
-    uint8_t *p = p_hci_event->data;
+    mesh_light_ctl_client_node_t *p_node;
 
-    UINT16_TO_STREAM(p, p_data->present.temperature);
-    UINT16_TO_STREAM(p, p_data->present.delta_uv);
-    UINT16_TO_STREAM(p, p_data->target.temperature);
-    UINT16_TO_STREAM(p, p_data->target.delta_uv);
-    UINT32_TO_STREAM(p, p_data->remaining_time);
-
-    mesh_transport_send_data(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_STATUS, (uint8_t *)p_hci_event, (uint16_t)(p - (uint8_t *)p_hci_event));
+    for (p_node = mesh_light_ctl_client_cache; p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]; p_node++)
+    {
+        if (p_node->addr == 0)
+            return WICED_TRUE;
+    }
+    return WICED_FALSE;
 }
 
 /*
-* Send Light CTL Temperature Range Status event over transport
-*/
-void mesh_light_ctl_hci_event_send_temperature_range_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_temperature_range_status_data_t *p_data)
+ * Save state received in a status message from a server
+ */
+void mesh_light_ctl_client_cache_update(uint16_t addr, uint8_t kind, void *p_data)
 {
-    uint8_t *p = p_hci_event->data;
+    mesh_light_ctl_client_node_t *p_node = mesh_light_ctl_client_cache_find(addr, WICED_TRUE);
+    wiced_bt_mesh_light_ctl_status_data_t *p_status = (wiced_bt_mesh_light_ctl_status_data_t *)p_data;
+    wiced_bt_mesh_light_ctl_temperature_range_status_data_t *p_range = (wiced_bt_mesh_light_ctl_temperature_range_status_data_t *)p_data;
+
+    if (p_node == NULL)
+        return;
+
+    switch (kind)
+    {
+    case MESH_LIGHT_CTL_CLIENT_CACHE_CTL:
+        p_node->ctl = *p_status;
+        break;
+
+    case MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE:
+        p_node->temperature = *p_status;
+        break;
+
+    case MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT:
+        p_node->default_status = ((wiced_bt_mesh_light_ctl_default_data_t *)p_data)->default_status;
+        break;
 
-    UINT8_TO_STREAM(p, p_data->status);
-    UINT16_TO_STREAM(p, p_data->min_level);
-    UINT16_TO_STREAM(p, p_data->max_level);
+    case MESH_LIGHT_CTL_CLIENT_CACHE_RANGE:
+        p_node->range_status = p_range->status;
+        p_node->range_min    = p_range->min_level;
+        p_node->range_max    = p_range->max_level;
+        break;
+    }
+    p_node->valid |= (1 << kind);
+    p_node->stale &= ~(1 << kind);
+    p_node->time[kind] = p_node->last_used;
+    mesh_light_ctl_client_nvram_mark(p_node);
+}
 
-    mesh_transport_send_data(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_RANGE_STATUS, (uint8_t *)p_hci_event, (uint16_t)(p - (uint8_t *)p_hci_event));
+/*
+ * Forget cached state which is going to be changed by a set message. For a group or
+ * virtual destination the state of all servers is dropped.
+ */
+void mesh_light_ctl_client_cache_invalidate(uint16_t addr, uint8_t kind_mask)
+{
+    mesh_light_ctl_client_node_t *p_node;
+
+    if (MESH_LIGHT_CTL_CLIENT_IS_UNICAST(addr))
+    {
+        if ((p_node = mesh_light_ctl_client_cache_find(addr, WICED_FALSE)) != NULL)
+        {
+            p_node->valid     &= ~kind_mask;
+            p_node->forwarded &= ~kind_mask;
+        }
+        return;
+    }
+    for (p_node = mesh_light_ctl_client_cache; p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]; p_node++)
+    {
+        p_node->valid     &= ~kind_mask;
+        p_node->forwarded &= ~kind_mask;
+    }
+}
+
+/*
+ * Get commands may carry an optional 2 byte maximum age in milliseconds, 0 if not present. If the requested
+ * state of a unicast destination was received within that time, the status is sent to
+ * the host from the cache and nothing is sent over the mesh. MESH_LIGHT_CTL_CLIENT_CACHE_ANY_AGE
+ * also accepts state restored from NVRAM. Returns WICED_TRUE if the command has been
+ * completed and p_event released. Otherwise the get is sent and its reply is forwarded to the
+ * host even if it did not change.
+ * Event: server address (2 bytes), age of the state in ms (4 bytes), opcode of the status event
+ * which carried the state (2 bytes) and the data of that status event.
+ */
+wiced_bool_t mesh_light_ctl_client_cache_reply(wiced_bt_mesh_event_t *p_event, uint8_t kind, uint16_t max_age)
+{
+#ifdef HCI_CONTROL
+    const mesh_light_ctl_codec_message_t *p_msg;
+    mesh_light_ctl_client_node_t *p_node;
+    wiced_bt_mesh_light_ctl_status_data_t status;
+    wiced_bt_mesh_light_ctl_default_data_t default_status;
+    wiced_bt_mesh_light_ctl_temperature_range_status_data_t range_status;
+    void *p_status;
+    uint8_t buffer[8 + MESH_LIGHT_CTL_CLIENT_HCI_DATA_LEN];
+    uint8_t *p = buffer;
+    uint16_t length;
+    uint32_t age;
+
+    if ((max_age == 0) || ((p_node = mesh_light_ctl_client_cache_find(p_event->dst, WICED_FALSE)) == NULL) ||
+        ((p_node->valid & (1 << kind)) == 0))
+    {
+        mesh_light_ctl_client_filter_expect(p_event->dst, kind);
+        return WICED_FALSE;
+    }
+    age = wiced_bt_mesh_core_get_tick_count() - p_node->time[kind];
+    if ((max_age != MESH_LIGHT_CTL_CLIENT_CACHE_ANY_AGE) && ((age > max_age) || (p_node->stale & (1 << kind))))
+    {
+        mesh_light_ctl_client_filter_expect(p_event->dst, kind);
+        return WICED_FALSE;
+    }
+
+    MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_CACHE_REPLY, p_event->dst, kind, age);
+
+    switch (kind)
+    {
+    case MESH_LIGHT_CTL_CLIENT_CACHE_CTL:
+    case MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE:
+        status = (kind == MESH_LIGHT_CTL_CLIENT_CACHE_CTL) ? p_node->ctl : p_node->temperature;
+        // Transition continued on the server since the status was received
+        status.remaining_time = (status.remaining_time > age) ? status.remaining_time - age : 0;
+        p_msg    = &mesh_light_ctl_codec_messages[(kind == MESH_LIGHT_CTL_CLIENT_CACHE_CTL) ? MESH_LIGHT_CTL_CODEC_STATUS : MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS];
+        p_status = &status;
+        break;
+
+    case MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT:
+        default_status.default_status = p_node->default_status;
+        p_msg    = &mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS];
+        p_status = &default_status;
+        break;
+
+    default:
+        range_status.status    = p_node->range_status;
+        range_status.min_level = p_node->range_min;
+        range_status.max_level = p_node->range_max;
+        p_msg    = &mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS];
+        p_status = &range_status;
+        break;
+    }
+    UINT16_TO_STREAM(p, p_event->dst);
+    UINT32_TO_STREAM(p, age);
+    UINT16_TO_STREAM(p, p_msg->opcode);
+    length = mesh_light_ctl_codec_encode(p_msg, p_status, p, sizeof(buffer) - (p - buffer));
+    if (length != MESH_LIGHT_CTL_CODEC_ERROR)
+        mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHED_STATUS, buffer, (uint16_t)(p - buffer + length));
+
+    wiced_bt_mesh_release_event(p_event);
+    return WICED_TRUE;
+#else
+    return WICED_FALSE;
+#endif
+}
+
+/*
+ * Write the state of a cache entry to the stream, all zeros if nothing is known about the server.
+ * Record: address (2 bytes), valid kinds (1 byte), Temperature Range status (1 byte), present
+ * lightness, newest temperature and delta UV (6 bytes), default lightness, temperature and delta UV
+ * (6 bytes), range minimum and maximum (4 bytes). Kinds are bit masks of (1 << MESH_LIGHT_CTL_CLIENT_CACHE_xxx).
+ */
+uint8_t *mesh_light_ctl_client_cache_to_stream(uint8_t *p, mesh_light_ctl_client_node_t *p_node)
+{
+    if ((p_node->addr == 0) || (p_node->valid == 0))
+    {
+        memset(p, 0, MESH_LIGHT_CTL_CLIENT_CACHE_RECORD_LEN);
+        return p + MESH_LIGHT_CTL_CLIENT_CACHE_RECORD_LEN;
+    }
+    UINT16_TO_STREAM(p, p_node->addr);
+    UINT8_TO_STREAM(p, p_node->valid);
+    UINT8_TO_STREAM(p, p_node->range_status);
+    UINT16_TO_STREAM(p, p_node->ctl.present.lightness);
+    UINT16_TO_STREAM(p, mesh_light_ctl_client_cache_temperature(p_node));
+    UINT16_TO_STREAM(p, p_node->temperature.present.delta_uv);
+    UINT16_TO_STREAM(p, p_node->default_status.lightness);
+    UINT16_TO_STREAM(p, p_node->default_status.temperature);
+    UINT16_TO_STREAM(p, p_node->default_status.delta_uv);
+    UINT16_TO_STREAM(p, p_node->range_min);
+    UINT16_TO_STREAM(p, p_node->range_max);
+    return p;
+}
+
+/*
+ * Present temperature from the newer of the CTL Status and the Temperature Status
+ */
+uint16_t mesh_light_ctl_client_cache_temperature(mesh_light_ctl_client_node_t *p_node)
+{
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    if (((p_node->valid & (1 << MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE)) == 0) ||
+        (((p_node->valid & (1 << MESH_LIGHT_CTL_CLIENT_CACHE_CTL)) != 0) &&
+         ((now - p_node->time[MESH_LIGHT_CTL_CLIENT_CACHE_CTL]) < (now - p_node->time[MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE]))))
+        return p_node->ctl.present.temperature;
+    return p_node->temperature.present.temperature;
+}
+
+/*
+ * Age in seconds of the newest state kept for a server
+ */
+uint32_t mesh_light_ctl_client_cache_age(mesh_light_ctl_client_node_t *p_node)
+{
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+    uint32_t age = 0xFFFFFFFF;
+    uint8_t kind;
+
+    if (p_node->valid == 0)
+        return 0;
+
+    for (kind = 0; kind < MESH_LIGHT_CTL_CLIENT_CACHE_KINDS; kind++)
+    {
+        if ((p_node->valid & (1 << kind)) && ((now - p_node->time[kind]) < age))
+            age = now - p_node->time[kind];
+    }
+    return age / 1000;
+}
+
+/*
+ * Cache entry has changed, schedule write of its block to NVRAM
+ */
+void mesh_light_ctl_client_nvram_mark(mesh_light_ctl_client_node_t *p_node)
+{
+    if (MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL == 0)
+        return;
+
+    mesh_light_ctl_client_nvram_dirty |= 1u << ((p_node - mesh_light_ctl_client_cache) / MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS);
+    if (!wiced_is_timer_in_use(&mesh_light_ctl_client_nvram_timer))
+        wiced_start_timer(&mesh_light_ctl_client_nvram_timer, MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL);
+}
+
+/*
+ * Write the records of a block of cache entries to p_buffer, each followed by its age in seconds.
+ * Returns the length of the block. The hash covers the records without the ages, so that a server
+ * which keeps sending the same state does not cause NVRAM writes.
+ */
+uint16_t mesh_light_ctl_client_nvram_block(uint8_t block, uint8_t *p_buffer, uint32_t *p_hash)
+{
+    mesh_light_ctl_client_node_t *p_node = &mesh_light_ctl_client_cache[block * MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS];
+    uint8_t *p = p_buffer;
+    uint8_t *p_byte;
+    uint8_t i;
+
+    // FNV-1a
+    *p_hash = 2166136261u;
+    for (i = 0; (i < MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS) && (p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]); i++, p_node++)
+    {
+        p_byte = p;
+        p = mesh_light_ctl_client_cache_to_stream(p, p_node);
+        for (; p_byte < p; p_byte++)
+            *p_hash = (*p_hash ^ *p_byte) * 16777619u;
+        UINT32_TO_STREAM(p, mesh_light_ctl_client_cache_age(p_node));
+    }
+    return (uint16_t)(p - p_buffer);
+}
+
+/*
+ * Load the cache saved before the reboot. Restored state is stale: it is reported by
+ * HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CACHE_DUMP and used for gets with MESH_LIGHT_CTL_CLIENT_CACHE_ANY_AGE,
+ * until the server sends a new status. The age saved is the age at the time of the write, so the
+ * restored age does not include the time the device was off.
+ */
+void mesh_light_ctl_client_nvram_restore(void)
+{
+    mesh_light_ctl_client_node_t *p_node;
+    uint8_t buffer[MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS * MESH_LIGHT_CTL_CLIENT_NVRAM_RECORD_LEN];
+    uint8_t *p;
+    uint8_t block, kind;
+    uint16_t len;
+    uint32_t age;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+    wiced_result_t result;
+
+    // Application init is called again when the node gets provisioned, keep what has been received
+    if ((MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL == 0) || mesh_light_ctl_client_nvram_restored)
+        return;
+    mesh_light_ctl_client_nvram_restored = WICED_TRUE;
+
+    for (block = 0; block < MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS; block++)
+    {
+        len = wiced_hal_read_nvram(MESH_LIGHT_CTL_CLIENT_NVRAM_ID + block, sizeof(buffer), buffer, &result);
+        if (result != WICED_SUCCESS)
+            continue;
+
+        p_node = &mesh_light_ctl_client_cache[block * MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS];
+        for (p = buffer; (p + MESH_LIGHT_CTL_CLIENT_NVRAM_RECORD_LEN <= &buffer[len]) && (p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]); p_node++)
+        {
+            STREAM_TO_UINT16(p_node->addr, p);
+            STREAM_TO_UINT8(p_node->valid, p);
+            STREAM_TO_UINT8(p_node->range_status, p);
+            STREAM_TO_UINT16(p_node->ctl.present.lightness, p);
+            STREAM_TO_UINT16(p_node->ctl.present.temperature, p);
+            STREAM_TO_UINT16(p_node->temperature.present.delta_uv, p);
+            STREAM_TO_UINT16(p_node->default_status.lightness, p);
+            STREAM_TO_UINT16(p_node->default_status.temperature, p);
+            STREAM_TO_UINT16(p_node->default_status.delta_uv, p);
+            STREAM_TO_UINT16(p_node->range_min, p);
+            STREAM_TO_UINT16(p_node->range_max, p);
+            STREAM_TO_UINT32(age, p);
+
+            p_node->valid &= (1 << MESH_LIGHT_CTL_CLIENT_CACHE_KINDS) - 1;
+            if (!MESH_LIGHT_CTL_CLIENT_IS_UNICAST(p_node->addr) || (p_node->valid == 0))
+            {
+                memset(p_node, 0, sizeof(*p_node));
+                continue;
+            }
+            // Transitions have finished while the device was off
+            p_node->temperature.present.temperature = p_node->ctl.present.temperature;
+            p_node->ctl.target         = p_node->ctl.present;
+            p_node->temperature.target = p_node->temperature.present;
+            p_node->stale  = p_node->valid;
+            age = ((age < MESH_LIGHT_CTL_CLIENT_NVRAM_MAX_AGE) ? age : MESH_LIGHT_CTL_CLIENT_NVRAM_MAX_AGE) * 1000;
+            p_node->last_used = now - age;
+            for (kind = 0; kind < MESH_LIGHT_CTL_CLIENT_CACHE_KINDS; kind++)
+                p_node->time[kind] = now - age;
+        }
+        // Block is not written again until a record changes
+        mesh_light_ctl_client_nvram_block(block, buffer, &mesh_light_ctl_client_nvram_hash[block]);
+        WICED_BT_TRACE("ctl nvram restore block:%d len:%d\n", block, len);
+    }
+}
+
+/*
+ * Delete the saved cache when the node is not provisioned. Blocks are read first so that
+ * nothing is written to NVRAM if there is nothing to delete.
+ */
+void mesh_light_ctl_client_nvram_erase(void)
+{
+    uint8_t buffer[MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS * MESH_LIGHT_CTL_CLIENT_NVRAM_RECORD_LEN];
+    uint8_t block;
+    wiced_result_t result;
+
+    if (MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL == 0)
+        return;
+
+    for (block = 0; block < MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS; block++)
+    {
+        if ((wiced_hal_read_nvram(MESH_LIGHT_CTL_CLIENT_NVRAM_ID + block, sizeof(buffer), buffer, &result) != 0) && (result == WICED_SUCCESS))
+            wiced_hal_delete_nvram(MESH_LIGHT_CTL_CLIENT_NVRAM_ID + block, &result);
+        mesh_light_ctl_client_nvram_hash[block] = 0;
+    }
+}
+
+/*
+ * Write one changed block of the cache to NVRAM. Blocks are taken in turn so that a busy
+ * server does not keep the others from being saved.
+ */
+void mesh_light_ctl_client_nvram_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    uint8_t buffer[MESH_LIGHT_CTL_CLIENT_NVRAM_RECORDS * MESH_LIGHT_CTL_CLIENT_NVRAM_RECORD_LEN];
+    uint8_t block, i;
+    uint16_t len;
+    uint32_t hash;
+    wiced_result_t result;
+
+    for (i = 0; i < MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS; i++)
+    {
+        block = (mesh_light_ctl_client_nvram_next + i) % MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS;
+        if ((mesh_light_ctl_client_nvram_dirty & (1u << block)) == 0)
+            continue;
+
+        mesh_light_ctl_client_nvram_dirty &= ~(1u << block);
+        len = mesh_light_ctl_client_nvram_block(block, buffer, &hash);
+        if (hash == mesh_light_ctl_client_nvram_hash[block])
+            continue;
+
+        wiced_hal_write_nvram(MESH_LIGHT_CTL_CLIENT_NVRAM_ID + block, len, buffer, &result);
+        WICED_BT_TRACE("ctl nvram save block:%d result:%d\n", block, result);
+        if (result == WICED_SUCCESS)
+            mesh_light_ctl_client_nvram_hash[block] = hash;
+        else
+            mesh_light_ctl_client_nvram_dirty |= 1u << block;
+        mesh_light_ctl_client_nvram_next = (block + 1) % MESH_LIGHT_CTL_CLIENT_NVRAM_BLOCKS;
+        break;
+    }
+    if (mesh_light_ctl_client_nvram_dirty != 0)
+        wiced_start_timer(&mesh_light_ctl_client_nvram_timer, MESH_LIGHT_CTL_CLIENT_NVRAM_INTERVAL);
+}
+
+/*
+ * Configure handling of set temperatures outside of the server range.
+ * Data: MESH_LIGHT_CTL_CLIENT_RANGE_xxx mode (1 byte).
+ */
+void mesh_light_ctl_client_range_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 1)
+    {
+        WICED_BT_TRACE("ctl range config bad len:%d\n", length);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+    if (p_data[0] > MESH_LIGHT_CTL_CLIENT_RANGE_REJECT)
+    {
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+#endif
+        return;
+    }
+    mesh_light_ctl_client_range_mode = p_data[0];
+    WICED_BT_TRACE("ctl range mode:%d\n", mesh_light_ctl_client_range_mode);
+}
+
+/*
+ * Check temperature of a set to a unicast destination against the range of the server.
+ * If the range is not known yet it is requested, without delaying this set. A server which is
+ * not in the cache gets a free entry for its Range Status. Sets do not take entries from other
+ * servers, so once the cache is full such a server is not checked. Returns WICED_FALSE if the
+ * set is rejected, in which case p_event has been released and the host has been told.
+ */
+wiced_bool_t mesh_light_ctl_client_range_check(wiced_bt_mesh_event_t *p_event, uint16_t opcode, uint16_t *p_temperature)
+{
+    mesh_light_ctl_client_node_t *p_node;
+    mesh_light_ctl_client_event_hdr_t hdr;
+    wiced_bt_mesh_event_t *p_range_event;
+    uint16_t temperature = *p_temperature;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    if ((mesh_light_ctl_client_range_mode == MESH_LIGHT_CTL_CLIENT_RANGE_OFF) || !MESH_LIGHT_CTL_CLIENT_IS_UNICAST(p_event->dst))
+        return WICED_TRUE;
+
+    if ((p_node = mesh_light_ctl_client_cache_find(p_event->dst, WICED_FALSE)) == NULL)
+    {
+        if (!mesh_light_ctl_client_cache_has_free())
+            return WICED_TRUE;
+        p_node = mesh_light_ctl_client_cache_find(p_event->dst, WICED_TRUE);
+    }
+
+    if ((p_node->valid & (1 << MESH_LIGHT_CTL_CLIENT_CACHE_RANGE)) == 0)
+    {
+        if ((p_node->range_request_time == 0) || ((now - p_node->range_request_time) >= MESH_LIGHT_CTL_CLIENT_RANGE_RETRY_TIME))
+        {
+            mesh_light_ctl_client_save_event_hdr(&hdr, p_event);
+            hdr.reply = WICED_TRUE;
+            if ((p_range_event = mesh_light_ctl_client_create_event(&hdr)) != NULL)
+            {
+                p_node->range_request_time = (now != 0) ? now : 1;
+                mesh_light_ctl_client_send(p_range_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET, NULL, MESH_LIGHT_CTL_CLIENT_OWNER_INTERNAL);
+            }
+        }
+        return WICED_TRUE;
+    }
+    // Range with an error status or unknown limits (0) is not used
+    if ((p_node->range_status != 0) || (p_node->range_min == 0) || (p_node->range_max == 0) ||
+        ((temperature >= p_node->range_min) && (temperature <= p_node->range_max)))
+        return WICED_TRUE;
+
+    WICED_BT_TRACE("ctl temp out of range dst:%04x temp:%d min/max:%d/%d\n", p_event->dst, temperature, p_node->range_min, p_node->range_max);
+
+    if (mesh_light_ctl_client_range_mode == MESH_LIGHT_CTL_CLIENT_RANGE_REJECT)
+    {
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(opcode, MESH_LIGHT_CTL_CLIENT_COMMAND_OUT_OF_RANGE);
+#endif
+        return WICED_FALSE;
+    }
+    *p_temperature = (temperature < p_node->range_min) ? p_node->range_min : p_node->range_max;
+#ifdef HCI_CONTROL
+    mesh_light_ctl_client_command_status(opcode, MESH_LIGHT_CTL_CLIENT_COMMAND_CLAMPED);
+#endif
+    return WICED_TRUE;
+}
+
+/*
+ * Store a daily lightness and temperature curve for the destination of the command header and
+ * start running it. Keyframes which the server can reach by interpolating between their neighbours
+ * within the tolerance are dropped. For each remaining segment one set is sent, with the transition
+ * time of the segment, so that the server interpolates.
+ * Data: current minute of the day (2 bytes), lightness tolerance (2 bytes), temperature tolerance
+ * (2 bytes), number of keyframes (1 byte, 0 to stop the curve) followed by keyframes of minute of the
+ * day, lightness and temperature (2 bytes each) in increasing minute order. A curve which is not
+ * valid is refused and the curve already running for the destination is kept.
+ */
+void mesh_light_ctl_client_curve_set(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+{
+    mesh_light_ctl_client_keyframe_t keyframes[MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAMES];
+    mesh_light_ctl_client_curve_t *p_curve;
+    mesh_light_ctl_client_curve_t *p_free = NULL;
+    uint16_t minute, tolerance_lightness, tolerance_temperature;
+    uint8_t num, i;
+
+    if ((length < 7) || ((p_data[6] <= MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAMES) &&
+        (length < 7 + MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAME_LEN * (uint32_t)p_data[6])))
+    {
+        WICED_BT_TRACE("ctl curve bad len:%d\n", length);
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+    STREAM_TO_UINT16(minute, p_data);
+    STREAM_TO_UINT16(tolerance_lightness, p_data);
+    STREAM_TO_UINT16(tolerance_temperature, p_data);
+    STREAM_TO_UINT8(num, p_data);
+    if ((minute >= 1440) || (num > MESH_LIGHT_CTL_CLIENT_CURVE_KEYFRAMES))
+    {
+        WICED_BT_TRACE("ctl curve bad minute:%d keyframes:%d\n", minute, num);
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+#endif
+        return;
+    }
+    for (i = 0; i < num; i++)
+    {
+        STREAM_TO_UINT16(keyframes[i].minute, p_data);
+        STREAM_TO_UINT16(keyframes[i].lightness, p_data);
+        STREAM_TO_UINT16(keyframes[i].temperature, p_data);
+        if ((keyframes[i].minute >= 1440) || ((i != 0) && (keyframes[i].minute <= keyframes[i - 1].minute)))
+        {
+            WICED_BT_TRACE("ctl curve bad keyframe:%d\n", i);
+            wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+            mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+#endif
+            return;
+        }
+    }
+    for (p_curve = mesh_light_ctl_client_curves; p_curve < &mesh_light_ctl_client_curves[MESH_LIGHT_CTL_CLIENT_CURVES]; p_curve++)
+    {
+        if (p_curve->dst == p_event->dst)
+            break;
+        if ((p_curve->dst == 0) && (p_free == NULL))
+            p_free = p_curve;
+    }
+    if (p_curve == &mesh_light_ctl_client_curves[MESH_LIGHT_CTL_CLIENT_CURVES])
+        p_curve = p_free;
+
+    if (num == 0)
+    {
+        WICED_BT_TRACE("ctl curve stop dst:%04x\n", p_event->dst);
+        if (p_curve != NULL)
+            p_curve->dst = 0;
+        wiced_bt_mesh_release_event(p_event);
+        mesh_light_ctl_client_curve_schedule();
+        return;
+    }
+    if (p_curve == NULL)
+    {
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET, MESH_LIGHT_CTL_CLIENT_COMMAND_NO_RESOURCES);
+#endif
+        return;
+    }
+    // Time of the day is kept from now on
+    mesh_light_ctl_client_day_ms   = (uint32_t)minute * 60000;
+    mesh_light_ctl_client_day_tick = wiced_bt_mesh_core_get_tick_count();
+
+    mesh_light_ctl_client_save_event_hdr(&p_curve->hdr, p_event);
+    wiced_bt_mesh_release_event(p_event);
+    memcpy(p_curve->keyframes, keyframes, num * sizeof(keyframes[0]));
+    p_curve->dst           = p_curve->hdr.dst;
+    p_curve->num_keyframes = mesh_light_ctl_client_curve_simplify(p_curve->keyframes, num, tolerance_lightness, tolerance_temperature);
+    p_curve->next_ms       = mesh_light_ctl_client_day_ms;
+
+    WICED_BT_TRACE("ctl curve dst:%04x keyframes:%d kept:%d\n", p_curve->dst, num, p_curve->num_keyframes);
+    mesh_light_ctl_client_curve_schedule();
+}
+
+/*
+ * Drop keyframes which linear interpolation between the kept keyframes around them reproduces
+ * within the tolerance. Returns the number of keyframes kept, which are moved to the start of the array.
+ */
+uint8_t mesh_light_ctl_client_curve_simplify(mesh_light_ctl_client_keyframe_t *p_keyframes, uint8_t num, uint16_t tolerance_lightness, uint16_t tolerance_temperature)
+{
+    mesh_light_ctl_client_keyframe_t *p_first, *p_last, *p_k;
+    uint8_t kept = 1;
+    uint8_t i = 0, j, k;
+    int32_t span, lightness, temperature;
+
+    while (i < num - 1)
+    {
+        // Extend the segment from keyframe i as long as all keyframes inside it are within the tolerance
+        for (j = i + 2; j < num; j++)
+        {
+            p_first = &p_keyframes[i];
+            p_last  = &p_keyframes[j];
+            span    = p_last->minute - p_first->minute;
+            for (k = i + 1; k < j; k++)
+            {
+                p_k = &p_keyframes[k];
+                lightness   = p_first->lightness + ((int32_t)p_last->lightness - p_first->lightness) * (p_k->minute - p_first->minute) / span;
+                temperature = p_first->temperature + ((int32_t)p_last->temperature - p_first->temperature) * (p_k->minute - p_first->minute) / span;
+                if ((lightness - p_k->lightness > tolerance_lightness) || (p_k->lightness - lightness > tolerance_lightness) ||
+                    (temperature - p_k->temperature > tolerance_temperature) || (p_k->temperature - temperature > tolerance_temperature))
+                    break;
+            }
+            if (k < j)
+                break;
+        }
+        i = j - 1;
+        p_keyframes[kept++] = p_keyframes[i];
+    }
+    return kept;
+}
+
+/*
+ * Current time of the day in ms
+ */
+uint32_t mesh_light_ctl_client_curve_clock(void)
+{
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    mesh_light_ctl_client_day_ms   = (mesh_light_ctl_client_day_ms + (now - mesh_light_ctl_client_day_tick)) % MESH_LIGHT_CTL_CLIENT_DAY;
+    mesh_light_ctl_client_day_tick = now;
+    return mesh_light_ctl_client_day_ms;
+}
+
+/*
+ * Send the set which starts the transition of the curve at next_ms, delayed on the server by delay ms.
+ * Transitions longer than the maximum are sent in steps to the interpolated value.
+ */
+void mesh_light_ctl_client_curve_step(mesh_light_ctl_client_curve_t *p_curve, uint16_t delay)
+{
+    mesh_light_ctl_client_keyframe_t *p_from, *p_to;
+    mesh_light_ctl_client_params_t params;
+    wiced_bt_mesh_event_t *p_event;
+    int32_t start = (int32_t)p_curve->next_ms;
+    int32_t from_ms, to_ms, end;
+    uint8_t i;
+
+    // Segment which contains the start, the last keyframe of the day continues into the first of the next
+    for (i = p_curve->num_keyframes; i > 0; i--)
+    {
+        if ((int32_t)p_curve->keyframes[i - 1].minute * 60000 <= start)
+            break;
+    }
+    p_from  = &p_curve->keyframes[(i == 0) ? p_curve->num_keyframes - 1 : i - 1];
+    p_to    = &p_curve->keyframes[(i == 0) ? 0 : i % p_curve->num_keyframes];
+    from_ms = (int32_t)p_from->minute * 60000 - ((i == 0) ? MESH_LIGHT_CTL_CLIENT_DAY : 0);
+    to_ms   = (int32_t)p_to->minute * 60000 + ((i == p_curve->num_keyframes) ? MESH_LIGHT_CTL_CLIENT_DAY : 0);
+
+    end = (to_ms - start > MESH_LIGHT_CTL_CLIENT_CURVE_MAX_STEP) ? start + MESH_LIGHT_CTL_CLIENT_CURVE_MAX_STEP : to_ms;
+
+    params.set.target.lightness   = (uint16_t)(p_from->lightness + ((int64_t)p_to->lightness - p_from->lightness) * (end - from_ms) / (to_ms - from_ms));
+    params.set.target.temperature = (uint16_t)(p_from->temperature + ((int64_t)p_to->temperature - p_from->temperature) * (end - from_ms) / (to_ms - from_ms));
+    params.set.target.delta_uv    = 0;
+    params.set.transition_time    = (uint32_t)(end - start);
+    params.set.delay              = delay;
+
+    p_curve->next_ms = (uint32_t)end % MESH_LIGHT_CTL_CLIENT_DAY;
+
+    WICED_BT_TRACE("ctl curve dst:%04x lightness:%d temp:%d time:%d\n", p_curve->dst, params.set.target.lightness,
+            params.set.target.temperature, params.set.transition_time);
+
+    p_curve->hdr.dst = p_curve->dst;
+    if ((p_event = mesh_light_ctl_client_create_event(&p_curve->hdr)) == NULL)
+    {
+        WICED_BT_TRACE("ctl curve no event dst:%04x\n", p_curve->dst);
+        return;
+    }
+    mesh_light_ctl_client_cache_invalidate(p_curve->dst, (1 << MESH_LIGHT_CTL_CLIENT_CACHE_CTL) | (1 << MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE));
+    mesh_light_ctl_client_send(p_event, HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, &params, MESH_LIGHT_CTL_CLIENT_OWNER_INTERNAL);
+}
+
+/*
+ * Send sets of curves whose next transition starts within the lead time, or has just been
+ * missed, and restart the timer for the next one
+ */
+void mesh_light_ctl_client_curve_schedule(void)
+{
+    mesh_light_ctl_client_curve_t *p_curve;
+    uint32_t now_ms = mesh_light_ctl_client_curve_clock();
+    uint32_t next = 0xFFFFFFFF;
+    uint32_t diff;
+
+    if (wiced_is_timer_in_use(&mesh_light_ctl_client_curve_timer))
+        wiced_stop_timer(&mesh_light_ctl_client_curve_timer);
+
+    for (p_curve = mesh_light_ctl_client_curves; p_curve < &mesh_light_ctl_client_curves[MESH_LIGHT_CTL_CLIENT_CURVES]; p_curve++)
+    {
+        if (p_curve->dst == 0)
+            continue;
+
+        diff = (p_curve->next_ms + MESH_LIGHT_CTL_CLIENT_DAY - now_ms) % MESH_LIGHT_CTL_CLIENT_DAY;
+        while ((diff <= MESH_LIGHT_CTL_CLIENT_CURVE_LEAD) || (diff > MESH_LIGHT_CTL_CLIENT_DAY - MESH_LIGHT_CTL_CLIENT_CURVE_LATE))
+        {
+            // Set sent early is delayed on the server so that the transition starts on time
+            mesh_light_ctl_client_curve_step(p_curve, (diff <= MESH_LIGHT_CTL_CLIENT_CURVE_LEAD) ? (uint16_t)diff : 0);
+            diff = (p_curve->next_ms + MESH_LIGHT_CTL_CLIENT_DAY - now_ms) % MESH_LIGHT_CTL_CLIENT_DAY;
+        }
+        if (diff - MESH_LIGHT_CTL_CLIENT_CURVE_LEAD < next)
+            next = diff - MESH_LIGHT_CTL_CLIENT_CURVE_LEAD;
+    }
+    if (next != 0xFFFFFFFF)
+        wiced_start_timer(&mesh_light_ctl_client_curve_timer, next);
+}
+
+/*
+ * Next transition of at least one curve is about to start
+ */
+void mesh_light_ctl_client_curve_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    mesh_light_ctl_client_curve_schedule();
+}
+
+/*
+ * Set the minimum interval in milliseconds between two sets sent to the same destination.
+ * Data: 2 byte interval, 0 sends every set immediately.
+ */
+void mesh_light_ctl_client_coalesce_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 2)
+    {
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_COALESCE_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+
+    STREAM_TO_UINT16(mesh_light_ctl_client_coalesce_interval, p_data);
+    WICED_BT_TRACE("ctl coalesce interval:%d\n", mesh_light_ctl_client_coalesce_interval);
+
+    // Sets waiting to be sent go out with the next timer expiration, or now if coalescing is disabled
+    mesh_light_ctl_client_coalesce_schedule();
+}
+
+/*
+ * Light CTL Set and Light CTL Temperature Set to the same destination are sent at most once
+ * per coalesce interval. A set received before the interval passes replaces the waiting set
+ * with the same opcode, so only the newest value goes out. A waiting set with the other opcode
+ * carries other fields and is sent first to keep the order of the host. Returns WICED_TRUE
+ * if the set is kept to be sent later, WICED_FALSE if it should be sent now.
+ */
+wiced_bool_t mesh_light_ctl_client_coalesce(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params)
+{
+    mesh_light_ctl_client_coalesce_t *p_slot;
+    mesh_light_ctl_client_coalesce_t *p_free = NULL;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    if (mesh_light_ctl_client_coalesce_interval == 0)
+        return WICED_FALSE;
+
+    for (p_slot = mesh_light_ctl_client_coalesce_slots; p_slot < &mesh_light_ctl_client_coalesce_slots[MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS]; p_slot++)
+    {
+        if ((p_slot->opcode != 0) && (p_slot->dst == p_event->dst))
+            break;
+
+        // Slot which is not holding a set can be taken, prefer the one used longest time ago
+        if ((p_slot->p_event == NULL) && ((p_free == NULL) || (p_slot->opcode == 0) ||
+            ((p_free->opcode != 0) && ((now - p_slot->sent_time) > (now - p_free->sent_time)))))
+            p_free = p_slot;
+    }
+    if (p_slot == &mesh_light_ctl_client_coalesce_slots[MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS])
+    {
+        // First set to this destination, or all slots busy, send immediately
+        if (p_free != NULL)
+        {
+            p_free->dst       = p_event->dst;
+            p_free->opcode    = opcode;
+            p_free->sent_time = now;
+        }
+        return WICED_FALSE;
+    }
+    if ((p_slot->p_event != NULL) && (p_slot->opcode != opcode))
+        mesh_light_ctl_client_coalesce_send(p_slot, now);
+
+    if ((p_slot->p_event == NULL) && ((now - p_slot->sent_time) >= mesh_light_ctl_client_coalesce_interval))
+    {
+        p_slot->opcode    = opcode;
+        p_slot->sent_time = now;
+        return WICED_FALSE;
+    }
+    if (p_slot->p_event != NULL)
+    {
+        WICED_BT_TRACE("ctl coalesce drop dst:%04x\n", p_slot->dst);
+        wiced_bt_mesh_release_event(p_slot->p_event);
+    }
+    p_slot->p_event = p_event;
+    p_slot->opcode  = opcode;
+    p_slot->params  = *p_params;
+    p_slot->rx_time = mesh_light_ctl_client_rx_time;
+
+    mesh_light_ctl_client_coalesce_schedule();
+    return WICED_TRUE;
+}
+
+/*
+ * Send sets which have waited for the coalesce interval and restart the timer for the next one
+ */
+void mesh_light_ctl_client_coalesce_schedule(void)
+{
+    mesh_light_ctl_client_coalesce_t *p_slot;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+    uint32_t elapsed;
+    uint32_t next = 0xFFFFFFFF;
+
+    if (wiced_is_timer_in_use(&mesh_light_ctl_client_coalesce_timer))
+        wiced_stop_timer(&mesh_light_ctl_client_coalesce_timer);
+
+    for (p_slot = mesh_light_ctl_client_coalesce_slots; p_slot < &mesh_light_ctl_client_coalesce_slots[MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS]; p_slot++)
+    {
+        if (p_slot->p_event == NULL)
+            continue;
+
+        elapsed = now - p_slot->sent_time;
+        if (elapsed < mesh_light_ctl_client_coalesce_interval)
+        {
+            if (mesh_light_ctl_client_coalesce_interval - elapsed < next)
+                next = mesh_light_ctl_client_coalesce_interval - elapsed;
+            continue;
+        }
+        mesh_light_ctl_client_coalesce_send(p_slot, now);
+    }
+    if (next != 0xFFFFFFFF)
+        wiced_start_timer(&mesh_light_ctl_client_coalesce_timer, next);
+}
+
+/*
+ * Send the set waiting in the slot
+ */
+void mesh_light_ctl_client_coalesce_send(mesh_light_ctl_client_coalesce_t *p_slot, uint32_t now)
+{
+    wiced_bt_mesh_event_t *p_event = p_slot->p_event;
+    uint32_t rx_time = mesh_light_ctl_client_rx_time;
+
+    p_slot->p_event   = NULL;
+    p_slot->sent_time = now;
+
+    // Latency is measured from the time the host sent the set
+    mesh_light_ctl_client_rx_time = p_slot->rx_time;
+    mesh_light_ctl_client_stagger(p_event, p_slot->opcode, &p_slot->params, WICED_FALSE);
+    mesh_light_ctl_client_rx_time = rx_time;
+}
+
+/*
+ * Coalesce interval passed for at least one of the waiting sets
+ */
+void mesh_light_ctl_client_coalesce_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    mesh_light_ctl_client_coalesce_schedule();
+}
+
+/*
+ * Process command to configure pacing of group and list sends.
+ * Data: slot time in ms reserved for one status reply (2 bytes, 0 to disable), number of servers
+ * expected to reply to a group message (2 bytes), maximum random delay in ms (2 bytes).
+ */
+void mesh_light_ctl_client_stagger_config(uint8_t *p_data, uint32_t length)
+{
+    uint16_t slot_time, network_size, jitter;
+
+    if (length < 6)
+    {
+        WICED_BT_TRACE("ctl stagger config bad len:%d\n", length);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+    STREAM_TO_UINT16(slot_time, p_data);
+    STREAM_TO_UINT16(network_size, p_data);
+    STREAM_TO_UINT16(jitter, p_data);
+    if (network_size == 0)
+    {
+        WICED_BT_TRACE("ctl stagger config bad network size\n");
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+#endif
+        return;
+    }
+    WICED_BT_TRACE("ctl stagger config slot:%d network size:%d jitter:%d\n", slot_time, network_size, jitter);
+
+    mesh_light_ctl_client_stagger_slot_time    = slot_time;
+    mesh_light_ctl_client_stagger_network_size = network_size;
+    mesh_light_ctl_client_stagger_jitter       = jitter;
+}
+
+/*
+ * Pass Light CTL Client message to the request layer, paced if pacing is enabled. An acknowledged
+ * message to a group is followed by a gap of one slot per server expected to reply, and each message
+ * of a destination list by one slot. Other messages are sent immediately unless paced messages are
+ * waiting, in which case they are queued without delay behind them to keep the order of commands.
+ * The command is refused with a busy status if the queue is full.
+ */
+void mesh_light_ctl_client_stagger(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params, wiced_bool_t is_list)
+{
+    mesh_light_ctl_client_stagger_t *p_msg;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+    uint32_t due_time;
+    uint32_t spacing;
+    wiced_bool_t is_group = !MESH_LIGHT_CTL_CLIENT_IS_UNICAST(p_event->dst) && p_event->reply;
+    wiced_bool_t is_paced = (mesh_light_ctl_client_stagger_slot_time != 0) && (is_list || is_group);
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    wiced_bool_t hold = (mesh_light_ctl_client_lpn_hold_time != 0);
+#else
+    wiced_bool_t hold = WICED_FALSE;
+#endif
+
+    if (!hold && !is_paced && (mesh_light_ctl_client_stagger_count == 0))
+    {
+        mesh_light_ctl_client_send(p_event, opcode, p_params, MESH_LIGHT_CTL_CLIENT_OWNER_HOST);
+        return;
+    }
+    if (mesh_light_ctl_client_stagger_count == MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS)
+    {
+        WICED_BT_TRACE("ctl stagger queue full dst:%04x\n", p_event->dst);
+        wiced_bt_mesh_release_event(p_event);
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(opcode, MESH_LIGHT_CTL_CLIENT_COMMAND_BUSY);
+#endif
+        return;
+    }
+    // Due times in the queue never decrease, an unpaced message is due with the last queued one
+    due_time = now;
+    if (mesh_light_ctl_client_stagger_count != 0)
+    {
+        p_msg = &mesh_light_ctl_client_stagger_queue[(mesh_light_ctl_client_stagger_head + mesh_light_ctl_client_stagger_count - 1) % MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS];
+        if ((int32_t)(now - p_msg->due_time) < 0)
+            due_time = p_msg->due_time;
+    }
+    if (is_paced)
+    {
+        spacing = mesh_light_ctl_client_stagger_slot_time;
+        if (is_group)
+            spacing *= mesh_light_ctl_client_stagger_network_size;
+
+        if ((int32_t)(due_time - mesh_light_ctl_client_stagger_next_time) < 0)
+            due_time = mesh_light_ctl_client_stagger_next_time;
+        if (mesh_light_ctl_client_stagger_jitter != 0)
+            due_time += wiced_hal_rand_gen_num() % (mesh_light_ctl_client_stagger_jitter + 1);
+        mesh_light_ctl_client_stagger_next_time = due_time + spacing;
+    }
+    if (!hold && (due_time == now) && (mesh_light_ctl_client_stagger_count == 0))
+    {
+        mesh_light_ctl_client_send(p_event, opcode, p_params, MESH_LIGHT_CTL_CLIENT_OWNER_HOST);
+        return;
+    }
+    p_msg = &mesh_light_ctl_client_stagger_queue[(mesh_light_ctl_client_stagger_head + mesh_light_ctl_client_stagger_count) % MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS];
+    mesh_light_ctl_client_stagger_count++;
+
+    p_msg->due_time = due_time;
+    p_msg->rx_time  = mesh_light_ctl_client_rx_time;
+    p_msg->opcode   = opcode;
+    p_msg->p_event  = p_event;
+    if (p_params != NULL)
+        p_msg->params = *p_params;
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    if (hold)
+    {
+        mesh_light_ctl_client_lpn_commands++;
+        if (!mesh_light_ctl_client_lpn_holding)
+        {
+            mesh_light_ctl_client_lpn_holding    = WICED_TRUE;
+            mesh_light_ctl_client_lpn_window_end = now + mesh_light_ctl_client_lpn_hold_time;
+            mesh_light_ctl_client_stagger_schedule();
+            return;
+        }
+    }
+#endif
+    if (mesh_light_ctl_client_stagger_count == 1)
+        mesh_light_ctl_client_stagger_schedule();
+}
+
+/*
+ * Send paced messages which are due and restart the timer for the next one. Due times in the
+ * queue never decrease, so only the head needs to be checked.
+ */
+void mesh_light_ctl_client_stagger_schedule(void)
+{
+    mesh_light_ctl_client_stagger_t *p_msg;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+    uint32_t rx_time = mesh_light_ctl_client_rx_time;
+
+    if (wiced_is_timer_in_use(&mesh_light_ctl_client_stagger_timer))
+        wiced_stop_timer(&mesh_light_ctl_client_stagger_timer);
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    if (mesh_light_ctl_client_lpn_holding)
+    {
+        if ((int32_t)(now - mesh_light_ctl_client_lpn_window_end) < 0)
+        {
+            wiced_start_timer(&mesh_light_ctl_client_stagger_timer, mesh_light_ctl_client_lpn_window_end - now);
+            return;
+        }
+        WICED_BT_TRACE("ctl lpn wake held:%d commands:%d wakeups:%d\n", mesh_light_ctl_client_stagger_count,
+                mesh_light_ctl_client_lpn_commands, mesh_light_ctl_client_lpn_wakeups + 1);
+        mesh_light_ctl_client_lpn_holding = WICED_FALSE;
+        mesh_light_ctl_client_lpn_wakeups++;
+    }
+#endif
+    while (mesh_light_ctl_client_stagger_count != 0)
+    {
+        p_msg = &mesh_light_ctl_client_stagger_queue[mesh_light_ctl_client_stagger_head];
+        if ((int32_t)(now - p_msg->due_time) < 0)
+        {
+            wiced_start_timer(&mesh_light_ctl_client_stagger_timer, p_msg->due_time - now);
+            break;
+        }
+        mesh_light_ctl_client_stagger_head = (mesh_light_ctl_client_stagger_head + 1) % MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS;
+        mesh_light_ctl_client_stagger_count--;
+
+        mesh_light_ctl_client_rx_time = p_msg->rx_time;
+        mesh_light_ctl_client_send(p_msg->p_event, p_msg->opcode, &p_msg->params, MESH_LIGHT_CTL_CLIENT_OWNER_HOST);
+    }
+    mesh_light_ctl_client_rx_time = rx_time;
+}
+
+/*
+ * Send time of the first paced message has come
+ */
+void mesh_light_ctl_client_stagger_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    mesh_light_ctl_client_stagger_schedule();
+}
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+/*
+ * Mesh core is going to sleep after the exchange with the friend. Held messages are sent now
+ * while the radio is still awake instead of waking it up again at the end of the hold time.
+ */
+void mesh_light_ctl_client_lpn_sleep(uint32_t max_sleep_duration)
+{
+    if (!mesh_light_ctl_client_lpn_holding)
+        return;
+
+    mesh_light_ctl_client_lpn_after_poll++;
+    mesh_light_ctl_client_lpn_window_end = wiced_bt_mesh_core_get_tick_count();
+    mesh_light_ctl_client_stagger_schedule();
+}
+
+#ifdef HCI_CONTROL
+/*
+ * Send low power node batching counters to the host.
+ * Data: optional 1 byte, non-zero to clear the counters after reading.
+ * Event: messages held (4 bytes), wake windows used to send them (4 bytes), wake windows which
+ * started right after a friend poll (4 bytes), hold time in ms (2 bytes).
+ */
+void mesh_light_ctl_client_lpn_stats_get(uint8_t *p_data, uint32_t length)
+{
+    uint8_t buffer[14];
+    uint8_t *p = buffer;
+
+    UINT32_TO_STREAM(p, mesh_light_ctl_client_lpn_commands);
+    UINT32_TO_STREAM(p, mesh_light_ctl_client_lpn_wakeups);
+    UINT32_TO_STREAM(p, mesh_light_ctl_client_lpn_after_poll);
+    UINT16_TO_STREAM(p, mesh_light_ctl_client_lpn_hold_time);
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LPN_STATS, buffer, (uint16_t)(p - buffer));
+
+    if ((length >= 1) && (p_data[0] != 0))
+    {
+        mesh_light_ctl_client_lpn_commands   = 0;
+        mesh_light_ctl_client_lpn_wakeups    = 0;
+        mesh_light_ctl_client_lpn_after_poll = 0;
+    }
+}
+#endif
+#endif
+
+/*
+ * Send Light CTL Client message. If request tracking is enabled, a message to a unicast
+ * address which expects a status is tracked. It is sent when fewer than the window of requests
+ * are in flight, retried if the status does not arrive in time, and reported to the host in
+ * HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE. Other messages are sent immediately and
+ * kept in the table only to measure latency. Requests started by the client itself are always tracked.
+ */
+void mesh_light_ctl_client_send(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params, uint8_t owner)
+{
+    mesh_light_ctl_client_request_t *p_req;
+    mesh_light_ctl_client_request_t rejected;
+    uint16_t status_event = 0;
+    uint8_t tracked;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    // Messages to groups and unacknowledged messages complete on TX complete
+    if (MESH_LIGHT_CTL_CLIENT_IS_UNICAST(p_event->dst) && p_event->reply)
+    {
+        switch (opcode)
+        {
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET:
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET:
+            status_event = WICED_BT_MESH_LIGHT_CTL_STATUS;
+            break;
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET:
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET:
+            status_event = WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS;
+            break;
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET:
+        case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET:
+            status_event = WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS;
+            break;
+        default:
+            status_event = WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS;
+            break;
+        }
+    }
+    tracked = (status_event != 0) && ((mesh_light_ctl_client_request_window != 0) || (owner != MESH_LIGHT_CTL_CLIENT_OWNER_HOST));
+
+    // Tracking is off, the message is sent without latency measurement
+    if (!tracked && (mesh_light_ctl_client_request_window == 0))
+    {
+        mesh_light_ctl_client_transmit(p_event, opcode, p_params);
+        return;
+    }
+
+    for (p_req = mesh_light_ctl_client_requests; p_req < &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS]; p_req++)
+    {
+        if (p_req->state == MESH_LIGHT_CTL_CLIENT_REQUEST_FREE)
+            break;
+    }
+    if (p_req == &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS])
+    {
+        // Untracked message is sent without latency measurement
+        if (!tracked)
+        {
+            mesh_light_ctl_client_transmit(p_event, opcode, p_params);
+            return;
+        }
+        // Table is full, the request is completed right away so that the host knows it was not sent
+        WICED_BT_TRACE("ctl request table full dst:%04x\n", p_event->dst);
+        p_req = &rejected;
+    }
+    p_req->state        = MESH_LIGHT_CTL_CLIENT_REQUEST_QUEUED;
+    p_req->tracked      = tracked;
+    p_req->owner        = owner;
+    p_req->tx_complete  = WICED_FALSE;
+    p_req->retries      = 0;
+    p_req->id           = mesh_light_ctl_client_request_id++;
+    p_req->opcode       = opcode;
+    p_req->status_event = status_event;
+    p_req->start_time   = (mesh_light_ctl_client_rx_time != 0) ? mesh_light_ctl_client_rx_time : now;
+    p_req->p_event      = p_event;
+    p_req->p_sent       = NULL;
+
+    // Retries of a tracked request are made either by the client or by the model, not by both
+    if (tracked && (mesh_light_ctl_client_request_retries != 0))
+        p_event->retrans_cnt = 0;
+    mesh_light_ctl_client_save_event_hdr(&p_req->hdr, p_event);
+    if (p_params != NULL)
+        p_req->params = *p_params;
+
+    if (p_req == &rejected)
+    {
+        mesh_light_ctl_client_request_complete(p_req, MESH_LIGHT_CTL_CLIENT_RESULT_NO_RESOURCES);
+        return;
+    }
+    if (!tracked)
+        mesh_light_ctl_client_request_start(p_req, now);
+
+    mesh_light_ctl_client_request_schedule();
+}
+
+/*
+ * Send the message of a request table entry for the first time
+ */
+void mesh_light_ctl_client_request_start(mesh_light_ctl_client_request_t *p_req, uint32_t now)
+{
+    wiced_bt_mesh_event_t *p_event = p_req->p_event;
+
+    p_req->p_event   = NULL;
+    p_req->p_sent    = p_event;
+    p_req->state     = MESH_LIGHT_CTL_CLIENT_REQUEST_IN_FLIGHT;
+    p_req->sent_time = now;
+    mesh_light_ctl_client_latency_add(p_req, MESH_LIGHT_CTL_CLIENT_STAGE_QUEUE, now - p_req->start_time);
+
+    mesh_light_ctl_client_transmit(p_event, p_req->opcode, &p_req->params);
+}
+
+/*
+ * Send Light CTL Client message over the mesh
+ */
+void mesh_light_ctl_client_transmit(wiced_bt_mesh_event_t *p_event, uint16_t opcode, mesh_light_ctl_client_params_t *p_params)
+{
+    switch (opcode)
+    {
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET:
+        wiced_bt_mesh_model_light_ctl_client_send_get(p_event);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET:
+        wiced_bt_mesh_model_light_ctl_client_send_set(p_event, &p_params->set);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET:
+        wiced_bt_mesh_model_light_ctl_client_send_temperature_get(p_event);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET:
+        wiced_bt_mesh_model_light_ctl_client_send_temperature_set(p_event, &p_params->temperature_set);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET:
+        wiced_bt_mesh_model_light_ctl_client_send_temperature_range_get(p_event);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET:
+        wiced_bt_mesh_model_light_ctl_client_send_temperature_range_set(p_event, &p_params->range_set);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET:
+        wiced_bt_mesh_model_light_ctl_client_send_default_get(p_event);
+        break;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET:
+        wiced_bt_mesh_model_light_ctl_client_send_default_set(p_event, &p_params->default_set);
+        break;
+    default:
+        wiced_bt_mesh_release_event(p_event);
+        return;
+    }
+#ifdef HCI_CONTROL
+    mesh_light_ctl_client_tx_pending++;
+#endif
+}
+
+/*
+ * Configure request tracking.
+ * Data: window (1 byte, number of requests in flight, 0 to disable tracking), timeout in ms (2 bytes),
+ * number of retries (1 byte). While the client retries, tracked requests are sent without
+ * retransmissions by the model. With 0 retries the model retransmits as set in the command header
+ * and a request fails when the model gives up.
+ */
+void mesh_light_ctl_client_request_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 4)
+    {
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+    if ((p_data[1] | p_data[2]) == 0)
+    {
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+#endif
+        return;
+    }
+
+    STREAM_TO_UINT8(mesh_light_ctl_client_request_window, p_data);
+    STREAM_TO_UINT16(mesh_light_ctl_client_request_timeout, p_data);
+    STREAM_TO_UINT8(mesh_light_ctl_client_request_retries, p_data);
+    WICED_BT_TRACE("ctl request window:%d timeout:%d retries:%d\n", mesh_light_ctl_client_request_window,
+            mesh_light_ctl_client_request_timeout, mesh_light_ctl_client_request_retries);
+
+    // Window may have been increased or tracking disabled, send what can be sent now
+    mesh_light_ctl_client_request_schedule();
+}
+
+/*
+ * Status received from a server completes the oldest request to it waiting for that status
+ */
+void mesh_light_ctl_client_request_status(uint16_t src, uint16_t event)
+{
+    mesh_light_ctl_client_request_t *p_oldest = mesh_light_ctl_client_request_find(src, event);
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    if (p_oldest != NULL)
+    {
+        mesh_light_ctl_client_latency_add(p_oldest, MESH_LIGHT_CTL_CLIENT_STAGE_RESPONSE, now - p_oldest->sent_time);
+        mesh_light_ctl_client_request_complete(p_oldest, MESH_LIGHT_CTL_CLIENT_RESULT_SUCCESS);
+        mesh_light_ctl_client_request_schedule();
+    }
+}
+
+/*
+ * Find the oldest request in flight to src which is completed by the status event
+ */
+mesh_light_ctl_client_request_t *mesh_light_ctl_client_request_find(uint16_t src, uint16_t event)
+{
+    mesh_light_ctl_client_request_t *p_req;
+    mesh_light_ctl_client_request_t *p_oldest = NULL;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    for (p_req = mesh_light_ctl_client_requests; p_req < &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS]; p_req++)
+    {
+        if ((p_req->state == MESH_LIGHT_CTL_CLIENT_REQUEST_IN_FLIGHT) && (p_req->hdr.dst == src) && (p_req->status_event == event) &&
+            ((p_oldest == NULL) || ((now - p_req->start_time) > (now - p_oldest->start_time))))
+            p_oldest = p_req;
+    }
+    return p_oldest;
+}
+
+/*
+ * TX complete for a message to the mesh, messages which do not expect a status are done. The
+ * model returns the event of the transmission, so requests to the same destination are told apart.
+ * If the model made the retransmissions and the status did not come, the request has failed.
+ */
+void mesh_light_ctl_client_request_tx_complete(wiced_bt_mesh_event_t *p_event)
+{
+    mesh_light_ctl_client_request_t *p_req;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    for (p_req = mesh_light_ctl_client_requests; p_req < &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS]; p_req++)
+    {
+        if ((p_req->state == MESH_LIGHT_CTL_CLIENT_REQUEST_IN_FLIGHT) && !p_req->tx_complete && (p_req->p_sent == p_event))
+            break;
+    }
+    if (p_req == &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS])
+        return;
+
+    p_req->tx_complete = WICED_TRUE;
+    p_req->p_sent      = NULL;
+    mesh_light_ctl_client_latency_add(p_req, MESH_LIGHT_CTL_CLIENT_STAGE_TX, now - p_req->sent_time);
+    if (p_req->status_event == 0)
+        mesh_light_ctl_client_request_complete(p_req, MESH_LIGHT_CTL_CLIENT_RESULT_SUCCESS);
+    else if ((p_event->status.tx_flag == TX_STATUS_FAILED) && p_req->tracked && (mesh_light_ctl_client_request_retries == 0))
+    {
+        MESH_LIGHT_CTL_TRACE(MESH_LIGHT_CTL_TRACE_REQUEST_FAILED, p_req->id, p_req->hdr.dst);
+        mesh_light_ctl_client_request_complete(p_req, MESH_LIGHT_CTL_CLIENT_RESULT_TIMEOUT);
+        mesh_light_ctl_client_request_schedule();
+    }
+}
+
+/*
+ * Report request completion to the host and free the request table entry.
+ * Data: request id (2 bytes), destination (2 bytes), HCI command (2 bytes), result (1 byte),
+ * number of retries (1 byte), time in ms from the command to completion (4 bytes).
+ */
+void mesh_light_ctl_client_request_complete(mesh_light_ctl_client_request_t *p_req, uint8_t result)
+{
+#ifdef HCI_CONTROL
+    uint8_t buffer[12];
+    uint8_t *p = buffer;
+#endif
+
+    if (p_req->p_event != NULL)
+        wiced_bt_mesh_release_event(p_req->p_event);
+
+    p_req->p_event = NULL;
+    p_req->p_sent  = NULL;
+    p_req->state   = MESH_LIGHT_CTL_CLIENT_REQUEST_FREE;
+
+    if (!p_req->tracked)
+        return;
+
+#ifdef HCI_CONTROL
+    if (p_req->owner == MESH_LIGHT_CTL_CLIENT_OWNER_SWEEP)
+    {
+        mesh_light_ctl_client_sweep_result(p_req->hdr.dst, result);
+        return;
+    }
+    if (p_req->owner == MESH_LIGHT_CTL_CLIENT_OWNER_INTERNAL)
+        return;
+    UINT16_TO_STREAM(p, p_req->id);
+    UINT16_TO_STREAM(p, p_req->hdr.dst);
+    UINT16_TO_STREAM(p, p_req->opcode);
+    UINT8_TO_STREAM(p, result);
+    UINT8_TO_STREAM(p, p_req->retries);
+    UINT32_TO_STREAM(p, wiced_bt_mesh_core_get_tick_count() - p_req->start_time);
+
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE, buffer, (uint16_t)(p - buffer));
+#endif
+}
+
+/*
+ * Retry or fail requests which timed out, send queued requests while the window allows,
+ * and restart the timer for the next timeout
+ */
+void mesh_light_ctl_client_request_schedule(void)
+{
+    // Completion of a request owned by the client may add a request while the table is processed
+    if (mesh_light_ctl_client_request_scheduling)
+    {
+        mesh_light_ctl_client_request_reschedule = WICED_TRUE;
+        return;
+    }
+    mesh_light_ctl_client_request_scheduling = WICED_TRUE;
+    do
+    {
+        mesh_light_ctl_client_request_reschedule = WICED_FALSE;
+        mesh_light_ctl_client_request_process();
+    } while (mesh_light_ctl_client_request_reschedule);
+    mesh_light_ctl_client_request_scheduling = WICED_FALSE;
+}
+
+/*
+ * One pass of mesh_light_ctl_client_request_schedule over the request table
+ */
+void mesh_light_ctl_client_request_process(void)
+{
+    mesh_light_ctl_client_request_t *p_req;
+    mesh_light_ctl_client_request_t *p_next;
+    wiced_bt_mesh_event_t *p_event;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+    uint32_t elapsed;
+    uint32_t next = 0xFFFFFFFF;
+    uint8_t in_flight = 0;
+
+    if (wiced_is_timer_in_use(&mesh_light_ctl_client_request_timer))
+        wiced_stop_timer(&mesh_light_ctl_client_request_timer);
+
+    for (p_req = mesh_light_ctl_client_requests; p_req < &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS]; p_req++)
+    {
+        if (p_req->state != MESH_LIGHT_CTL_CLIENT_REQUEST_IN_FLIGHT)
+            continue;
+
+        elapsed = now - p_req->sent_time;
+        if (elapsed < mesh_light_ctl_client_request_timeout)
+        {
+            if (p_req->tracked)
+                in_flight++;
+            continue;
+        }
+        if (!p_req->tracked || (p_req->retries >= mesh_light_ctl_client_request_retries) ||
+            ((p_event = mesh_light_ctl_client_create_event(&p_req->hdr)) == NULL))
+        {
+            WICED_BT_TRACE("ctl request timeout id:%d dst:%04x\n", p_req->id, p_req->hdr.dst);
+            mesh_light_ctl_client_request_complete(p_req, MESH_LIGHT_CTL_CLIENT_RESULT_TIMEOUT);
+            continue;
+        }
+        WICED_BT_TRACE("ctl request retry id:%d dst:%04x\n", p_req->id, p_req->hdr.dst);
+        p_req->retries++;
+        p_req->p_sent      = p_event;
+        p_req->sent_time   = now;
+        p_req->tx_complete = WICED_FALSE;
+        in_flight++;
+        mesh_light_ctl_client_transmit(p_event, p_req->opcode, &p_req->params);
+    }
+
+    // Queued requests are sent in the order they were received
+    while ((mesh_light_ctl_client_request_window == 0) || (in_flight < mesh_light_ctl_client_request_window))
+    {
+        p_next = NULL;
+        for (p_req = mesh_light_ctl_client_requests; p_req < &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS]; p_req++)
+        {
+            if ((p_req->state == MESH_LIGHT_CTL_CLIENT_REQUEST_QUEUED) &&
+                ((p_next == NULL) || ((now - p_req->start_time) > (now - p_next->start_time))))
+                p_next = p_req;
+        }
+        if (p_next == NULL)
+            break;
+
+        in_flight++;
+        mesh_light_ctl_client_request_start(p_next, now);
+    }
+
+    for (p_req = mesh_light_ctl_client_requests; p_req < &mesh_light_ctl_client_requests[MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS]; p_req++)
+    {
+        if ((p_req->state == MESH_LIGHT_CTL_CLIENT_REQUEST_IN_FLIGHT) && (mesh_light_ctl_client_request_timeout - (now - p_req->sent_time) < next))
+            next = mesh_light_ctl_client_request_timeout - (now - p_req->sent_time);
+    }
+    if (next != 0xFFFFFFFF)
+        wiced_start_timer(&mesh_light_ctl_client_request_timer, next);
+}
+
+/*
+ * Status of at least one request in flight did not arrive in time
+ */
+void mesh_light_ctl_client_request_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    mesh_light_ctl_client_request_schedule();
+}
+
+/*
+ * Index of a Light CTL command in the latency histograms
+ */
+uint8_t mesh_light_ctl_client_command_index(uint16_t opcode)
+{
+    switch (opcode)
+    {
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET:                     return 0;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET:                     return 1;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET:         return 2;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET:         return 3;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET:   return 4;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET:   return 5;
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET:             return 6;
+    default:                                                        return 7;
+    }
+}
+
+/*
+ * Add latency in ms of one stage of a message to its histogram
+ */
+void mesh_light_ctl_client_latency_add(mesh_light_ctl_client_request_t *p_req, uint8_t stage, uint32_t latency)
+{
+    uint16_t *p_count;
+    uint8_t bucket = 0;
+
+    while ((latency != 0) && (bucket < MESH_LIGHT_CTL_CLIENT_LATENCY_BUCKETS - 1))
+    {
+        latency >>= 1;
+        bucket++;
+    }
+    p_count = &mesh_light_ctl_client_latency[mesh_light_ctl_client_command_index(p_req->opcode)]
+            [MESH_LIGHT_CTL_CLIENT_IS_UNICAST(p_req->hdr.dst) ? MESH_LIGHT_CTL_CLIENT_DST_UNICAST : MESH_LIGHT_CTL_CLIENT_DST_GROUP][stage][bucket];
+    if (*p_count != 0xFFFF)
+        (*p_count)++;
+}
+
+#ifdef HCI_CONTROL
+/*
+ * Send latency histograms to the host, one HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LATENCY_HISTOGRAM event
+ * for each command and destination class. Messages are measured while request tracking is configured.
+ * Data: HCI command (2 bytes), destination class (1 byte), and for each stage (queue, TX, response)
+ * the counts of all buckets (2 bytes each).
+ */
+void mesh_light_ctl_client_latency_get(void)
+{
+    static const uint16_t commands[MESH_LIGHT_CTL_CLIENT_NUM_COMMANDS] =
+    {
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET,
+        HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET,
+    };
+    uint8_t buffer[3 + MESH_LIGHT_CTL_CLIENT_NUM_STAGES * MESH_LIGHT_CTL_CLIENT_LATENCY_BUCKETS * 2];
+    uint8_t *p;
+    uint8_t cmd, dst_class, stage, bucket;
+
+    for (cmd = 0; cmd < MESH_LIGHT_CTL_CLIENT_NUM_COMMANDS; cmd++)
+    {
+        for (dst_class = 0; dst_class < MESH_LIGHT_CTL_CLIENT_NUM_DST_CLASSES; dst_class++)
+        {
+            p = buffer;
+            UINT16_TO_STREAM(p, commands[cmd]);
+            UINT8_TO_STREAM(p, dst_class);
+            for (stage = 0; stage < MESH_LIGHT_CTL_CLIENT_NUM_STAGES; stage++)
+            {
+                for (bucket = 0; bucket < MESH_LIGHT_CTL_CLIENT_LATENCY_BUCKETS; bucket++)
+                    UINT16_TO_STREAM(p, mesh_light_ctl_client_latency[cmd][dst_class][stage][bucket]);
+            }
+            mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LATENCY_HISTOGRAM, buffer, (uint16_t)(p - buffer));
+        }
+    }
+}
+#endif
+
+#if defined(BINARY_TRACE) && (BINARY_TRACE == 1)
+/*
+ * Store trace record in the ring buffer. Called on the message receive path, so nothing
+ * is formatted here. If the ring is full the record is dropped and counted.
+ */
+void mesh_light_ctl_trace_put(uint8_t id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4)
+{
+    uint16_t head = mesh_light_ctl_trace_head;
+    mesh_light_ctl_trace_record_t *p_rec;
+
+    if ((uint16_t)(head - mesh_light_ctl_trace_tail) >= MESH_LIGHT_CTL_TRACE_RECORDS)
+    {
+        mesh_light_ctl_trace_dropped++;
+        return;
+    }
+    p_rec = &mesh_light_ctl_trace_ring[head & (MESH_LIGHT_CTL_TRACE_RECORDS - 1)];
+    p_rec->time   = wiced_bt_mesh_core_get_tick_count();
+    p_rec->id     = id;
+    p_rec->arg[0] = a0;
+    p_rec->arg[1] = a1;
+    p_rec->arg[2] = a2;
+    p_rec->arg[3] = a3;
+    p_rec->arg[4] = a4;
+
+    // Record is complete before it becomes visible to the reader
+    mesh_light_ctl_trace_head = head + 1;
+}
+
+/*
+ * Configure formatting of stored trace records.
+ * Data: interval in ms (2 bytes) at which records are printed, 0 to keep them to be read over HCI.
+ */
+void mesh_light_ctl_trace_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 2)
+    {
+#ifdef HCI_CONTROL
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+#endif
+        return;
+    }
+
+    STREAM_TO_UINT16(mesh_light_ctl_trace_drain_interval, p_data);
+
+    if (wiced_is_timer_in_use(&mesh_light_ctl_trace_drain_timer))
+        wiced_stop_timer(&mesh_light_ctl_trace_drain_timer);
+    if (mesh_light_ctl_trace_drain_interval != 0)
+        wiced_start_timer(&mesh_light_ctl_trace_drain_timer, mesh_light_ctl_trace_drain_interval);
+}
+
+/*
+ * Print stored trace records while the application is idle
+ */
+void mesh_light_ctl_trace_drain_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    mesh_light_ctl_trace_record_t *p_rec;
+
+    if (mesh_light_ctl_trace_dropped != 0)
+    {
+        WICED_BT_TRACE("ctl trace dropped:%d\n", mesh_light_ctl_trace_dropped);
+        mesh_light_ctl_trace_dropped = 0;
+    }
+    while (mesh_light_ctl_trace_tail != mesh_light_ctl_trace_head)
+    {
+        p_rec = &mesh_light_ctl_trace_ring[mesh_light_ctl_trace_tail & (MESH_LIGHT_CTL_TRACE_RECORDS - 1)];
+        WICED_BT_TRACE("%d: ", p_rec->time);
+        switch (p_rec->id)
+        {
+        case MESH_LIGHT_CTL_TRACE_MSG:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_MSG_FMT, p_rec->arg[0]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_TX_COMPLETE:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_TX_COMPLETE_FMT, p_rec->arg[0]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_STATUS:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_STATUS_FMT, p_rec->arg[0], p_rec->arg[1], p_rec->arg[2], p_rec->arg[3], p_rec->arg[4]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS_FMT, p_rec->arg[0], p_rec->arg[1], p_rec->arg[2]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS_FMT, p_rec->arg[0], p_rec->arg[1], p_rec->arg[2], p_rec->arg[3], p_rec->arg[4]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_RANGE_STATUS:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_RANGE_STATUS_FMT, p_rec->arg[0], p_rec->arg[1], p_rec->arg[2]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_CACHE_REPLY:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_CACHE_REPLY_FMT, p_rec->arg[0], p_rec->arg[1], p_rec->arg[2]);
+            break;
+        case MESH_LIGHT_CTL_TRACE_REQUEST_FAILED:
+            WICED_BT_TRACE(MESH_LIGHT_CTL_TRACE_REQUEST_FAILED_FMT, p_rec->arg[0], p_rec->arg[1]);
+            break;
+        default:
+            WICED_BT_TRACE("trace id:%d\n", p_rec->id);
+            break;
+        }
+        mesh_light_ctl_trace_tail++;
+    }
+    if (mesh_light_ctl_trace_drain_interval != 0)
+        wiced_start_timer(&mesh_light_ctl_trace_drain_timer, mesh_light_ctl_trace_drain_interval);
+}
+
+#ifdef HCI_CONTROL
+/*
+ * Send the trace records stored when the command is received to the host in
+ * HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TRACE_DATA events. Records added meanwhile are left for
+ * the next read, so the number of events is limited by the size of the ring. Records are
+ * removed only when their event is sent, reading stops if the transport refuses an event.
+ * Data: number of dropped records (2 bytes), number of records (1 byte), and for each record
+ * tick count (4 bytes), trace id (1 byte) and 5 arguments (4 bytes each).
+ */
+void mesh_light_ctl_trace_read(void)
+{
+    uint8_t buffer[MESH_LIGHT_CTL_TRACE_DATA_HDR_LEN + MESH_LIGHT_CTL_TRACE_DATA_RECORDS * MESH_LIGHT_CTL_TRACE_RECORD_LEN];
+    uint8_t *p;
+    uint8_t count;
+    uint8_t i;
+    uint16_t head = mesh_light_ctl_trace_head;
+    uint16_t tail;
+    mesh_light_ctl_trace_record_t *p_rec;
+
+    do
+    {
+        p = &buffer[MESH_LIGHT_CTL_TRACE_DATA_HDR_LEN];
+        tail = mesh_light_ctl_trace_tail;
+        for (count = 0; (count < MESH_LIGHT_CTL_TRACE_DATA_RECORDS) && (tail != head); count++)
+        {
+            p_rec = &mesh_light_ctl_trace_ring[tail & (MESH_LIGHT_CTL_TRACE_RECORDS - 1)];
+            UINT32_TO_STREAM(p, p_rec->time);
+            UINT8_TO_STREAM(p, p_rec->id);
+            for (i = 0; i < 5; i++)
+                UINT32_TO_STREAM(p, p_rec->arg[i]);
+            tail++;
+        }
+        buffer[0] = (uint8_t)mesh_light_ctl_trace_dropped;
+        buffer[1] = (uint8_t)(mesh_light_ctl_trace_dropped >> 8);
+        buffer[2] = count;
+
+        if (mesh_light_ctl_hci_transport_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TRACE_DATA, buffer, (uint16_t)(p - buffer)) != WICED_SUCCESS)
+        {
+            WICED_BT_TRACE("ctl trace read send failed\n");
+            break;
+        }
+        mesh_light_ctl_trace_dropped = 0;
+        mesh_light_ctl_trace_tail = tail;
+    } while (tail != head);
+}
+#endif
+#endif
+
+#if defined(HCI_CONTROL) && defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+/*
+ * Add a record to the capture: type (1 byte), ms since the previous record (2 bytes), opcode (2 bytes),
+ * length (2 bytes) and, except for events to the host, the data. Capture traffic is not recorded.
+ */
+void mesh_light_ctl_capture_put(uint8_t type, uint16_t opcode, uint8_t *p_data, uint16_t length)
+{
+    uint16_t data_len = (type == MESH_LIGHT_CTL_CAPTURE_EVENT) ? 0 : length;
+    uint32_t now, delta;
+    uint8_t *p;
+
+    if (!mesh_light_ctl_capture_enabled)
+        return;
+
+    switch (opcode)
+    {
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG:
+    case HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ:
+    case HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA:
+        if (type != MESH_LIGHT_CTL_CAPTURE_MESH)
+            return;
+        break;
+    }
+    if (mesh_light_ctl_capture_len + MESH_LIGHT_CTL_CAPTURE_HDR_LEN + data_len > MESH_LIGHT_CTL_CAPTURE_SIZE)
+    {
+        mesh_light_ctl_capture_dropped++;
+        return;
+    }
+    now   = wiced_bt_mesh_core_get_tick_count();
+    delta = (mesh_light_ctl_capture_len == 0) ? 0 : now - mesh_light_ctl_capture_time;
+    mesh_light_ctl_capture_time = now;
+
+    p = &mesh_light_ctl_capture[mesh_light_ctl_capture_len];
+    UINT8_TO_STREAM(p, type);
+    UINT16_TO_STREAM(p, (delta < 0xFFFF) ? delta : 0xFFFF);
+    UINT16_TO_STREAM(p, opcode);
+    UINT16_TO_STREAM(p, length);
+    memcpy(p, p_data, data_len);
+    mesh_light_ctl_capture_len += MESH_LIGHT_CTL_CAPTURE_HDR_LEN + data_len;
+}
+
+/*
+ * Start or stop recording of HCI traffic.
+ * Data: 1 byte, non-zero to clear the capture and start recording, 0 to stop recording.
+ */
+void mesh_light_ctl_capture_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 1)
+    {
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+        return;
+    }
+
+    mesh_light_ctl_capture_enabled = (p_data[0] != 0);
+    if (mesh_light_ctl_capture_enabled)
+    {
+        mesh_light_ctl_capture_len     = 0;
+        mesh_light_ctl_capture_dropped = 0;
+    }
+    WICED_BT_TRACE("ctl capture enabled:%d\n", mesh_light_ctl_capture_enabled);
+}
+
+/*
+ * Send the part of the capture which starts at the offset in the command to the host in
+ * HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA. The host reads the capture by sending the
+ * command again with the offset of the next part until a part without capture data is
+ * received. Commands are not replayed on the device, the host replays the capture on the
+ * simulated mesh of the host build.
+ * Command data: offset (2 bytes), 0 if not present.
+ * Event data: offset (2 bytes), capture length (2 bytes), records not recorded because the
+ * capture was full (2 bytes), followed by up to 200 bytes of the capture.
+ */
+void mesh_light_ctl_capture_read(uint8_t *p_data, uint32_t length)
+{
+    uint8_t buffer[6 + MESH_LIGHT_CTL_CAPTURE_CHUNK];
+    uint8_t *p = buffer;
+    uint16_t offset = 0;
+    uint16_t len = 0;
+
+    if (length >= 2)
+        STREAM_TO_UINT16(offset, p_data);
+
+    if (offset < mesh_light_ctl_capture_len)
+    {
+        len = mesh_light_ctl_capture_len - offset;
+        if (len > MESH_LIGHT_CTL_CAPTURE_CHUNK)
+            len = MESH_LIGHT_CTL_CAPTURE_CHUNK;
+    }
+    UINT16_TO_STREAM(p, offset);
+    UINT16_TO_STREAM(p, mesh_light_ctl_capture_len);
+    UINT16_TO_STREAM(p, mesh_light_ctl_capture_dropped);
+    memcpy(p, &mesh_light_ctl_capture[offset], len);
+
+    // The host sends the read again with the same offset if no part is received
+    if (mesh_light_ctl_hci_transport_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA, buffer, (uint16_t)(p + len - buffer)) != WICED_SUCCESS)
+        mesh_light_ctl_hci_send_failures++;
+}
+#endif
+
+#ifdef HCI_CONTROL
+/*
+ * Send a status event over transport, the layout of the message is taken from the codec
+ */
+void mesh_light_ctl_hci_event_send_state(wiced_bt_mesh_hci_event_t *p_hci_event, uint8_t message, void *p_data)
+{
+    const mesh_light_ctl_codec_message_t *p_msg = &mesh_light_ctl_codec_messages[message];
+    uint16_t length = mesh_light_ctl_codec_encode(p_msg, p_data, p_hci_event->data, MESH_LIGHT_CTL_CLIENT_HCI_DATA_LEN);
+
+    if (length == MESH_LIGHT_CTL_CODEC_ERROR)
+        return;
+
+    mesh_light_ctl_hci_statuses++;
+    mesh_light_ctl_hci_event_send(p_msg->opcode, (uint8_t *)p_hci_event, (uint16_t)(p_hci_event->data + length - (uint8_t *)p_hci_event));
+}
+
+/*
+ * Send event over transport. If batching is enabled the event is added to the batch
+ * buffer as opcode (2 bytes), length (1 byte) and the event data, and the buffer is sent as
+ * HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH when it is full, when the flush timer expires
+ * or before a TX complete event.
+ */
+void mesh_light_ctl_hci_event_send(uint16_t opcode, uint8_t *p_data, uint16_t length)
+{
+    uint8_t *p;
+
+    if ((mesh_light_ctl_hci_batch_flush_time == 0) || (length + 3 > MESH_LIGHT_CTL_CLIENT_BATCH_SIZE))
+    {
+        mesh_light_ctl_hci_batch_flush();
+        if (mesh_light_ctl_hci_transport_send(opcode, p_data, length) != WICED_SUCCESS)
+            mesh_light_ctl_hci_send_failures++;
+        return;
+    }
+    if (mesh_light_ctl_hci_batch_len + 3 + length > MESH_LIGHT_CTL_CLIENT_BATCH_SIZE)
+        mesh_light_ctl_hci_batch_flush();
+
+    p = &mesh_light_ctl_hci_batch[mesh_light_ctl_hci_batch_len];
+    UINT16_TO_STREAM(p, opcode);
+    UINT8_TO_STREAM(p, length);
+    memcpy(p, p_data, length);
+    mesh_light_ctl_hci_batch_len += 3 + length;
+    if (mesh_light_ctl_hci_batch_len > mesh_light_ctl_hci_batch_high_water)
+        mesh_light_ctl_hci_batch_high_water = mesh_light_ctl_hci_batch_len;
+
+    if (!wiced_is_timer_in_use(&mesh_light_ctl_hci_batch_timer))
+        wiced_start_timer(&mesh_light_ctl_hci_batch_timer, mesh_light_ctl_hci_batch_flush_time);
+}
+
+/*
+ * Send an event to the host. In credit mode the event is sent in HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SEQUENCED
+ * so that the host can detect lost events.
+ * Data: sequence number (2 bytes), opcode of the event (2 bytes) followed by the event data.
+ */
+wiced_result_t mesh_light_ctl_hci_transport_send(uint16_t opcode, uint8_t *p_data, uint16_t length)
+{
+    uint8_t *p = mesh_light_ctl_hci_sequenced;
+
+#if defined(HCI_CAPTURE) && (HCI_CAPTURE == 1)
+    mesh_light_ctl_capture_put(MESH_LIGHT_CTL_CAPTURE_EVENT, opcode, p_data, length);
+#endif
+
+    if (!mesh_light_ctl_client_credit_enabled)
+        return mesh_transport_send_data(opcode, p_data, length);
+
+    if (length > MESH_LIGHT_CTL_CLIENT_SEQUENCED_DATA_LEN)
+    {
+        WICED_BT_TRACE("ctl sequenced event too long opcode:%04x len:%d\n", opcode, length);
+        return WICED_ERROR;
+    }
+    UINT16_TO_STREAM(p, mesh_light_ctl_hci_seq);
+    UINT16_TO_STREAM(p, opcode);
+    memcpy(p, p_data, length);
+    mesh_light_ctl_hci_seq++;
+
+    return mesh_transport_send_data(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SEQUENCED, mesh_light_ctl_hci_sequenced, length + 4);
+}
+
+/*
+ * Configure status event batching.
+ * Data: 2 byte maximum time in ms a status can wait in the batch, 0 to send each status separately.
+ */
+void mesh_light_ctl_hci_batch_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 2)
+    {
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+        return;
+    }
+
+    mesh_light_ctl_hci_batch_flush();
+    STREAM_TO_UINT16(mesh_light_ctl_hci_batch_flush_time, p_data);
+    WICED_BT_TRACE("ctl status batch flush time:%d\n", mesh_light_ctl_hci_batch_flush_time);
+}
+
+/*
+ * Send all batched status events to the host
+ */
+void mesh_light_ctl_hci_batch_flush(void)
+{
+    if (wiced_is_timer_in_use(&mesh_light_ctl_hci_batch_timer))
+        wiced_stop_timer(&mesh_light_ctl_hci_batch_timer);
+
+    if (mesh_light_ctl_hci_batch_len == 0)
+        return;
+
+    if (mesh_light_ctl_hci_transport_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH, mesh_light_ctl_hci_batch, mesh_light_ctl_hci_batch_len) != WICED_SUCCESS)
+        mesh_light_ctl_hci_send_failures++;
+    mesh_light_ctl_hci_batch_len = 0;
+}
+
+/*
+ * Oldest status in the batch waited long enough
+ */
+void mesh_light_ctl_hci_batch_timer_cb(TIMER_PARAM_TYPE arg)
+{
+    mesh_light_ctl_hci_batch_flush();
+}
+
+/*
+ * Fill the header of the status event buffer from the mesh event
+ */
+wiced_bt_mesh_hci_event_t *mesh_light_ctl_hci_event_init(wiced_bt_mesh_event_t *p_event)
+{
+    wiced_bt_mesh_hci_event_t *p_hci_event = &mesh_light_ctl_hci_status.hdr;
+
+    p_hci_event->src         = p_event->src;
+    p_hci_event->app_key_idx = p_event->app_key_idx;
+    p_hci_event->element_idx = p_event->element_idx;
+    return p_hci_event;
+}
+
+/*
+ * Number of mesh events the client holds in its coalesce, stagger and request queues.
+ * Events handed to the mesh core are not counted.
+ */
+uint8_t mesh_light_ctl_client_events_held(void)
+{
+    uint8_t held = mesh_light_ctl_client_stagger_count;
+    uint8_t i;
+
+    for (i = 0; i < MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS; i++)
+    {
+        if (mesh_light_ctl_client_coalesce_slots[i].p_event != NULL)
+            held++;
+    }
+    for (i = 0; i < MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS; i++)
+    {
+        if (mesh_light_ctl_client_requests[i].p_event != NULL)
+            held++;
+    }
+    if (held > mesh_light_ctl_client_events_high_water)
+        mesh_light_ctl_client_events_high_water = held;
+    return held;
+}
+
+/*
+ * Enable or disable credit flow control. While it is enabled the host sends a command with a mesh
+ * header only if it holds a credit, and all events except TX complete are sent with a sequence number.
+ * Data: 1 to enable, 0 to disable (1 byte).
+ */
+void mesh_light_ctl_client_credit_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 1)
+    {
+        WICED_BT_TRACE("ctl credit config bad len:%d\n", length);
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CREDIT_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+        return;
+    }
+    // Events batched before the change are sent in the old format
+    mesh_light_ctl_hci_batch_flush();
+
+    mesh_light_ctl_client_credit_enabled = (p_data[0] != 0);
+    mesh_light_ctl_client_credits        = 0;
+    mesh_light_ctl_client_credit_overruns = 0;
+    mesh_light_ctl_hci_seq               = 0;
+    WICED_BT_TRACE("ctl credit enabled:%d\n", mesh_light_ctl_client_credit_enabled);
+
+    mesh_light_ctl_client_credit_update();
+}
+
+/*
+ * Grant the host credits for the mesh events which are free. Events held in the client queues and
+ * messages waiting for TX complete are in use, and so are the credits the host has not used yet.
+ * While messages go through the pacing queue the credits are also limited to its free slots.
+ * Event: credits granted (1 byte), credits the host holds including these (1 byte), commands
+ * received without a credit since credit mode was enabled (2 bytes).
+ */
+void mesh_light_ctl_client_credit_update(void)
+{
+    uint8_t buffer[4];
+    uint8_t *p = buffer;
+    uint8_t used;
+    uint8_t grant;
+    uint8_t room;
+    wiced_bool_t queued;
+
+    if (!mesh_light_ctl_client_credit_enabled)
+        return;
+
+    // Untracked messages are not in the request table, so messages waiting for TX complete are counted
+    // when they are handed to the mesh core
+    used = mesh_light_ctl_client_events_held() + mesh_light_ctl_client_credits + mesh_light_ctl_client_tx_pending;
+    if (used >= MESH_LIGHT_CTL_CLIENT_EVENT_BUDGET)
+        return;
+
+    grant = MESH_LIGHT_CTL_CLIENT_EVENT_BUDGET - used;
+
+    // Messages wait in the pacing queue while pacing or holding for the wake window, and a command
+    // which finds it full is refused
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    queued = (mesh_light_ctl_client_stagger_slot_time != 0) || (mesh_light_ctl_client_lpn_hold_time != 0);
+#else
+    queued = (mesh_light_ctl_client_stagger_slot_time != 0);
+#endif
+    if (queued)
+    {
+        room = MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS - mesh_light_ctl_client_stagger_count;
+        if (room <= mesh_light_ctl_client_credits)
+            return;
+        if (grant > room - mesh_light_ctl_client_credits)
+            grant = room - mesh_light_ctl_client_credits;
+    }
+
+    // Credits are granted in batches so that the host does not get an event for every command
+    if ((grant < MESH_LIGHT_CTL_CLIENT_CREDIT_BATCH) && (mesh_light_ctl_client_credits != 0))
+        return;
+
+    mesh_light_ctl_client_credits += grant;
+    UINT8_TO_STREAM(p, grant);
+    UINT8_TO_STREAM(p, mesh_light_ctl_client_credits);
+    UINT16_TO_STREAM(p, mesh_light_ctl_client_credit_overruns);
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CREDIT, buffer, (uint16_t)(p - buffer));
+}
+
+/*
+ * Choose the client element for a command which does not select one. The element with the fewest
+ * messages waiting to be sent or waiting for a status is used, elements with the same load in turn.
+ */
+uint8_t mesh_light_ctl_client_element_select(void)
+{
+    uint8_t load[MESH_LIGHT_CTL_CLIENT_ELEMENTS];
+    uint8_t element, best, i;
+
+    memset(load, 0, sizeof(load));
+    for (i = 0; i < MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS; i++)
+    {
+        element = mesh_light_ctl_client_requests[i].hdr.element_idx - MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX;
+        if ((mesh_light_ctl_client_requests[i].state != MESH_LIGHT_CTL_CLIENT_REQUEST_FREE) && (element < MESH_LIGHT_CTL_CLIENT_ELEMENTS))
+            load[element]++;
+    }
+    for (i = 0; i < mesh_light_ctl_client_stagger_count; i++)
+    {
+        element = mesh_light_ctl_client_stagger_queue[(mesh_light_ctl_client_stagger_head + i) % MESH_LIGHT_CTL_CLIENT_STAGGER_SLOTS].p_event->element_idx - MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX;
+        if (element < MESH_LIGHT_CTL_CLIENT_ELEMENTS)
+            load[element]++;
+    }
+    for (i = 0; i < MESH_LIGHT_CTL_CLIENT_COALESCE_SLOTS; i++)
+    {
+        if (mesh_light_ctl_client_coalesce_slots[i].p_event == NULL)
+            continue;
+        element = mesh_light_ctl_client_coalesce_slots[i].p_event->element_idx - MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX;
+        if (element < MESH_LIGHT_CTL_CLIENT_ELEMENTS)
+            load[element]++;
+    }
+    best = mesh_light_ctl_client_element_next;
+    for (i = 1; i < MESH_LIGHT_CTL_CLIENT_ELEMENTS; i++)
+    {
+        element = (mesh_light_ctl_client_element_next + i) % MESH_LIGHT_CTL_CLIENT_ELEMENTS;
+        if (load[element] < load[best])
+            best = element;
+    }
+    mesh_light_ctl_client_element_next = (best + 1) % MESH_LIGHT_CTL_CLIENT_ELEMENTS;
+    return MESH_LIGHT_CTL_CLIENT_ELEMENT_INDEX + best;
+}
+
+/*
+ * Tell the host that a command was not accepted, so that it can slow down and send it again.
+ * Data: HCI command (2 bytes), MESH_LIGHT_CTL_CLIENT_COMMAND_xxx status (1 byte), events held (1 byte).
+ */
+void mesh_light_ctl_client_command_status(uint16_t opcode, uint8_t status)
+{
+    uint8_t buffer[4];
+    uint8_t *p = buffer;
+
+    WICED_BT_TRACE("ctl command refused opcode:%04x status:%d\n", opcode, status);
+
+    UINT16_TO_STREAM(p, opcode);
+    UINT8_TO_STREAM(p, status);
+    UINT8_TO_STREAM(p, mesh_light_ctl_client_events_held());
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS, buffer, (uint16_t)(p - buffer));
+}
+
+/*
+ * Send event and buffer usage statistics to the host.
+ * Data: optional 1 byte, non-zero to clear counters and high water marks after reading.
+ * Event: events held, high water and budget (1 byte each), commands refused and event
+ * failures (2 bytes each), status events sent or batched (4 bytes), longest batch and batch
+ * size in bytes (2 bytes each), and transport failures (2 bytes).
+ */
+void mesh_light_ctl_client_pool_stats_get(uint8_t *p_data, uint32_t length)
+{
+    uint8_t buffer[17];
+    uint8_t *p = buffer;
+
+    UINT8_TO_STREAM(p, mesh_light_ctl_client_events_held());
+    UINT8_TO_STREAM(p, mesh_light_ctl_client_events_high_water);
+    UINT8_TO_STREAM(p, MESH_LIGHT_CTL_CLIENT_EVENT_BUDGET);
+    UINT16_TO_STREAM(p, mesh_light_ctl_client_events_refused);
+    UINT16_TO_STREAM(p, mesh_light_ctl_client_event_failures);
+    UINT32_TO_STREAM(p, mesh_light_ctl_hci_statuses);
+    UINT16_TO_STREAM(p, mesh_light_ctl_hci_batch_high_water);
+    UINT16_TO_STREAM(p, MESH_LIGHT_CTL_CLIENT_BATCH_SIZE);
+    UINT16_TO_STREAM(p, mesh_light_ctl_hci_send_failures);
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_POOL_STATS, buffer, (uint16_t)(p - buffer));
+
+    if ((length >= 1) && (p_data[0] != 0))
+    {
+        mesh_light_ctl_client_events_high_water = 0;
+        mesh_light_ctl_client_events_refused    = 0;
+        mesh_light_ctl_client_event_failures    = 0;
+        mesh_light_ctl_hci_statuses             = 0;
+        mesh_light_ctl_hci_batch_high_water     = mesh_light_ctl_hci_batch_len;
+        mesh_light_ctl_hci_send_failures        = 0;
+    }
+}
+
+/*
+ * Send the cached state of all known servers, including state restored from NVRAM which has not
+ * been received again since the reboot.
+ * Event: 1 if this is the last event of the dump (1 byte), number of entries (1 byte) followed by
+ * entries of the record described in mesh_light_ctl_client_cache_to_stream, stale kinds (1 byte) and
+ * age of the newest state in seconds (4 bytes).
+ */
+void mesh_light_ctl_client_cache_dump(void)
+{
+    mesh_light_ctl_client_node_t *p_node;
+    uint8_t buffer[2 + MESH_LIGHT_CTL_CLIENT_DUMP_CHUNK * MESH_LIGHT_CTL_CLIENT_DUMP_ENTRY_LEN];
+    uint8_t *p = &buffer[2];
+    uint8_t count = 0;
+
+    for (p_node = mesh_light_ctl_client_cache; p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]; p_node++)
+    {
+        if ((p_node->addr == 0) || (p_node->valid == 0))
+            continue;
+
+        p = mesh_light_ctl_client_cache_to_stream(p, p_node);
+        UINT8_TO_STREAM(p, p_node->stale & p_node->valid);
+        UINT32_TO_STREAM(p, mesh_light_ctl_client_cache_age(p_node));
+        if (++count == MESH_LIGHT_CTL_CLIENT_DUMP_CHUNK)
+        {
+            buffer[0] = 0;
+            buffer[1] = count;
+            mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHE_DUMP, buffer, (uint16_t)(p - buffer));
+            p = &buffer[2];
+            count = 0;
+        }
+    }
+    buffer[0] = 1;
+    buffer[1] = count;
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHE_DUMP, buffer, (uint16_t)(p - buffer));
+}
+
+/*
+ * Configure change only forwarding of statuses which were not requested by the host.
+ * Data: 1 to forward only changed statuses, 0 to forward all (1 byte), heartbeat interval in seconds
+ * after which an unchanged status is forwarded again (2 bytes, 0 for never).
+ */
+void mesh_light_ctl_client_filter_config(uint8_t *p_data, uint32_t length)
+{
+    if (length < 3)
+    {
+        WICED_BT_TRACE("ctl filter config bad len:%d\n", length);
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_CONFIG, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+        return;
+    }
+    STREAM_TO_UINT8(mesh_light_ctl_client_filter_enabled, p_data);
+    STREAM_TO_UINT16(mesh_light_ctl_client_filter_heartbeat, p_data);
+    WICED_BT_TRACE("ctl filter enabled:%d heartbeat:%d\n", mesh_light_ctl_client_filter_enabled, mesh_light_ctl_client_filter_heartbeat);
+}
+
+/*
+ * Change only forwarding. Returns WICED_FALSE if the status from src is the same as the last status of
+ * the same kind forwarded to the host and the heartbeat interval has not passed since. Statuses
+ * from a server which is not in the cache are forwarded.
+ */
+wiced_bool_t mesh_light_ctl_client_filter(uint16_t src, uint16_t event, void *p_data)
+{
+    mesh_light_ctl_client_node_t *p_node;
+    uint8_t buffer[MESH_LIGHT_CTL_CLIENT_HCI_DATA_LEN];
+    uint16_t length;
+    uint8_t *p_byte;
+    uint8_t kind, message;
+    uint32_t hash = 2166136261u;
+    uint32_t now = wiced_bt_mesh_core_get_tick_count();
+
+    if (!mesh_light_ctl_client_filter_enabled)
+        return WICED_TRUE;
+
+    switch (event)
+    {
+    case WICED_BT_MESH_LIGHT_CTL_STATUS:
+        kind    = MESH_LIGHT_CTL_CLIENT_CACHE_CTL;
+        message = MESH_LIGHT_CTL_CODEC_STATUS;
+        break;
+    case WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_STATUS:
+        kind    = MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE;
+        message = MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS;
+        break;
+    case WICED_BT_MESH_LIGHT_CTL_DEFAULT_STATUS:
+        kind    = MESH_LIGHT_CTL_CLIENT_CACHE_DEFAULT;
+        message = MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS;
+        break;
+    case WICED_BT_MESH_LIGHT_CTL_TEMPERATURE_RANGE_STATUS:
+        kind    = MESH_LIGHT_CTL_CLIENT_CACHE_RANGE;
+        message = MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS;
+        break;
+    default:
+        return WICED_TRUE;
+    }
+    // Status is hashed as it is sent to the host, structures may contain padding
+    length = mesh_light_ctl_codec_encode(&mesh_light_ctl_codec_messages[message], p_data, buffer, sizeof(buffer));
+    if ((length == MESH_LIGHT_CTL_CODEC_ERROR) || ((p_node = mesh_light_ctl_client_cache_find(src, WICED_FALSE)) == NULL))
+        return WICED_TRUE;
+
+    // FNV-1a
+    for (p_byte = buffer; p_byte < &buffer[length]; p_byte++)
+        hash = (hash ^ *p_byte) * 16777619u;
+
+    if ((p_node->forwarded & (1 << kind)) && (p_node->forward_hash[kind] == hash) &&
+        ((mesh_light_ctl_client_filter_heartbeat == 0) || ((now - p_node->forward_time[kind]) < (uint32_t)mesh_light_ctl_client_filter_heartbeat * 1000)))
+    {
+        mesh_light_ctl_client_filter_suppressed++;
+        return WICED_FALSE;
+    }
+    p_node->forwarded |= (1 << kind);
+    p_node->forward_hash[kind] = hash;
+    p_node->forward_time[kind] = now;
+    return WICED_TRUE;
+}
+
+/*
+ * Host sent a get over the mesh and waits for the reply, so the next status of the kind is
+ * forwarded even if it did not change. For a group or virtual destination this applies to all servers.
+ */
+void mesh_light_ctl_client_filter_expect(uint16_t dst, uint8_t kind)
+{
+    mesh_light_ctl_client_node_t *p_node;
+
+    for (p_node = mesh_light_ctl_client_cache; p_node < &mesh_light_ctl_client_cache[MESH_LIGHT_CTL_CLIENT_CACHE_SIZE]; p_node++)
+    {
+        if (!MESH_LIGHT_CTL_CLIENT_IS_UNICAST(dst) || (p_node->addr == dst))
+            p_node->forwarded &= ~(1 << kind);
+    }
+}
+
+/*
+ * Send number of statuses not forwarded because they did not change.
+ * Data: optional 1 byte, non-zero to clear the counter after reading.
+ * Event: statuses not forwarded (4 bytes).
+ */
+void mesh_light_ctl_client_filter_stats_get(uint8_t *p_data, uint32_t length)
+{
+    uint8_t buffer[4];
+    uint8_t *p = buffer;
+
+    UINT32_TO_STREAM(p, mesh_light_ctl_client_filter_suppressed);
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_FILTER_STATS, buffer, (uint16_t)(p - buffer));
+
+    if ((length >= 1) && (p_data[0] != 0))
+        mesh_light_ctl_client_filter_suppressed = 0;
+}
+
+/*
+ * Start sweep of a list or range of servers. Key and delivery parameters are taken from the command
+ * header, the destination is not used.
+ * Data: state to get (1 byte, 0 - CTL, 1 - Temperature, 2 - Temperature Range), number of gets in
+ * flight (1 byte), number of addresses (1 byte) followed by the addresses, or 0 followed by the first
+ * and the last address of a range.
+ * Results are sent in HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SWEEP_RESULT events, see mesh_light_ctl_client_sweep_flush.
+ */
+void mesh_light_ctl_client_sweep(wiced_bt_mesh_event_t *p_event, uint8_t *p_data, uint32_t length)
+{
+    static const uint8_t kinds[] = { MESH_LIGHT_CTL_CLIENT_CACHE_CTL, MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE, MESH_LIGHT_CTL_CLIENT_CACHE_RANGE };
+    mesh_light_ctl_client_sweep_t *p_sweep = &mesh_light_ctl_client_sweep_state;
+    uint8_t kind, concurrency, num_addr;
+    uint16_t first, last, i;
+
+    if (p_sweep->active)
+    {
+        wiced_bt_mesh_release_event(p_event);
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, MESH_LIGHT_CTL_CLIENT_COMMAND_BUSY);
+        return;
+    }
+    if ((length < 3) || (length < 3 + ((p_data[2] == 0) ? 4 : 2 * (uint32_t)p_data[2])))
+    {
+        WICED_BT_TRACE("ctl sweep bad len:%d\n", length);
+        wiced_bt_mesh_release_event(p_event);
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH);
+        return;
+    }
+    if ((p_data[0] >= sizeof(kinds)) || (p_data[2] > MESH_LIGHT_CTL_CLIENT_SWEEP_MAX_LIST))
+    {
+        WICED_BT_TRACE("ctl sweep bad kind:%d count:%d\n", p_data[0], p_data[2]);
+        wiced_bt_mesh_release_event(p_event);
+        mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+        return;
+    }
+    STREAM_TO_UINT8(kind, p_data);
+    STREAM_TO_UINT8(concurrency, p_data);
+    STREAM_TO_UINT8(num_addr, p_data);
+    if (num_addr == 0)
+    {
+        STREAM_TO_UINT16(first, p_data);
+        STREAM_TO_UINT16(last, p_data);
+        if (!MESH_LIGHT_CTL_CLIENT_IS_UNICAST(first) || !MESH_LIGHT_CTL_CLIENT_IS_UNICAST(last) || (last < first))
+        {
+            WICED_BT_TRACE("ctl sweep bad range:%04x-%04x\n", first, last);
+            wiced_bt_mesh_release_event(p_event);
+            mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+            return;
+        }
+        p_sweep->first = first;
+        p_sweep->count = last - first + 1;
+    }
+    else
+    {
+        for (i = 0; i < num_addr; i++)
+        {
+            STREAM_TO_UINT16(p_sweep->addr[i], p_data);
+            if (!MESH_LIGHT_CTL_CLIENT_IS_UNICAST(p_sweep->addr[i]))
+            {
+                WICED_BT_TRACE("ctl sweep bad addr:%04x\n", p_sweep->addr[i]);
+                wiced_bt_mesh_release_event(p_event);
+                mesh_light_ctl_client_command_status(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP, MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE);
+                return;
+            }
+        }
+        p_sweep->first = 0;
+        p_sweep->count = num_addr;
+    }
+    WICED_BT_TRACE("ctl sweep kind:%d count:%d concurrency:%d\n", kind, p_sweep->count, concurrency);
+
+    mesh_light_ctl_client_save_event_hdr(&p_sweep->hdr, p_event);
+    wiced_bt_mesh_release_event(p_event);
+    p_sweep->hdr.reply   = WICED_TRUE;
+    p_sweep->active      = WICED_TRUE;
+    p_sweep->kind        = kinds[kind];
+    p_sweep->concurrency = (concurrency == 0) ? 1 : (concurrency > MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS) ? MESH_LIGHT_CTL_CLIENT_MAX_REQUESTS : concurrency;
+    p_sweep->in_flight   = 0;
+    p_sweep->next        = 0;
+    p_sweep->num_results = 0;
+
+    mesh_light_ctl_client_sweep_next();
+}
+
+/*
+ * Send gets of the sweep while fewer than the concurrency limit are in flight, and
+ * finish the sweep when all addresses are done
+ */
+void mesh_light_ctl_client_sweep_next(void)
+{
+    mesh_light_ctl_client_sweep_t *p_sweep = &mesh_light_ctl_client_sweep_state;
+    wiced_bt_mesh_event_t *p_event;
+    uint16_t opcode;
+
+    if (p_sweep->submitting)
+        return;
+
+    switch (p_sweep->kind)
+    {
+    case MESH_LIGHT_CTL_CLIENT_CACHE_CTL:
+        opcode = HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET;
+        break;
+    case MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE:
+        opcode = HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET;
+        break;
+    default:
+        opcode = HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET;
+        break;
+    }
+    p_sweep->submitting = WICED_TRUE;
+    while ((p_sweep->in_flight < p_sweep->concurrency) && (p_sweep->next < p_sweep->count))
+    {
+        p_sweep->hdr.dst = (p_sweep->first != 0) ? p_sweep->first + p_sweep->next : p_sweep->addr[p_sweep->next];
+        p_sweep->next++;
+        p_sweep->in_flight++;
+        if ((p_event = mesh_light_ctl_client_create_event(&p_sweep->hdr)) == NULL)
+        {
+            mesh_light_ctl_client_sweep_result(p_sweep->hdr.dst, MESH_LIGHT_CTL_CLIENT_RESULT_NO_RESOURCES);
+            continue;
+        }
+        mesh_light_ctl_client_send(p_event, opcode, NULL, MESH_LIGHT_CTL_CLIENT_OWNER_SWEEP);
+    }
+    p_sweep->submitting = WICED_FALSE;
+
+    if ((p_sweep->in_flight == 0) && (p_sweep->next == p_sweep->count))
+    {
+        WICED_BT_TRACE("ctl sweep done\n");
+        p_sweep->active = WICED_FALSE;
+        mesh_light_ctl_client_sweep_flush(WICED_TRUE);
+    }
+}
+
+/*
+ * Get of one server of the sweep is completed. The values are taken from the cache which has
+ * just been updated with the status.
+ */
+void mesh_light_ctl_client_sweep_result(uint16_t addr, uint8_t result)
+{
+    mesh_light_ctl_client_sweep_t *p_sweep = &mesh_light_ctl_client_sweep_state;
+    mesh_light_ctl_client_node_t *p_node = NULL;
+    uint16_t value1 = 0, value2 = 0;
+    uint8_t flags = result;
+    uint8_t *p;
+
+    if (!p_sweep->active)
+        return;
+
+    if ((result == MESH_LIGHT_CTL_CLIENT_RESULT_SUCCESS) && ((p_node = mesh_light_ctl_client_cache_find(addr, WICED_FALSE)) != NULL))
+    {
+        switch (p_sweep->kind)
+        {
+        case MESH_LIGHT_CTL_CLIENT_CACHE_CTL:
+            value1 = p_node->ctl.present.lightness;
+            value2 = p_node->ctl.present.temperature;
+            break;
+        case MESH_LIGHT_CTL_CLIENT_CACHE_TEMPERATURE:
+            value1 = p_node->temperature.present.temperature;
+            value2 = p_node->temperature.present.delta_uv;
+            break;
+        default:
+            value1 = p_node->range_min;
+            value2 = p_node->range_max;
+            flags |= p_node->range_status << 4;
+            break;
+        }
+    }
+    p = &p_sweep->results[p_sweep->num_results * MESH_LIGHT_CTL_CLIENT_SWEEP_ENTRY_LEN];
+    UINT16_TO_STREAM(p, addr);
+    UINT16_TO_STREAM(p, value1);
+    UINT16_TO_STREAM(p, value2);
+    UINT8_TO_STREAM(p, flags);
+    if (++p_sweep->num_results == MESH_LIGHT_CTL_CLIENT_SWEEP_CHUNK)
+        mesh_light_ctl_client_sweep_flush(WICED_FALSE);
+
+    p_sweep->in_flight--;
+    mesh_light_ctl_client_sweep_next();
 }
 
 /*
- * Send Default Light CTL Default Status event over transport
+ * Send sweep results to the host.
+ * Data: 1 if this is the last event of the sweep (1 byte), number of entries (1 byte) followed by
+ * entries of address, two values and flags. Values are present lightness and temperature for CTL,
+ * present temperature and delta UV for Temperature, and range minimum and maximum for Temperature
+ * Range. Flags bits 0-3 are MESH_LIGHT_CTL_CLIENT_RESULT_xxx, bits 4-7 the Temperature Range status.
  */
-void mesh_light_ctl_hci_event_send_default_status(wiced_bt_mesh_hci_event_t *p_hci_event, wiced_bt_mesh_light_ctl_default_data_t *p_data)
+void mesh_light_ctl_client_sweep_flush(wiced_bool_t last)
 {
-    uint8_t *p = p_hci_event->data;
+    mesh_light_ctl_client_sweep_t *p_sweep = &mesh_light_ctl_client_sweep_state;
+    uint8_t buffer[2 + sizeof(p_sweep->results)];
+    uint8_t *p = buffer;
 
-    UINT16_TO_STREAM(p, p_data->default_status.lightness);
-    UINT16_TO_STREAM(p, p_data->default_status.temperature);
-    UINT16_TO_STREAM(p, p_data->default_status.delta_uv);
+    UINT8_TO_STREAM(p, last ? 1 : 0);
+    UINT8_TO_STREAM(p, p_sweep->num_results);
+    memcpy(p, p_sweep->results, p_sweep->num_results * MESH_LIGHT_CTL_CLIENT_SWEEP_ENTRY_LEN);
+    p += p_sweep->num_results * MESH_LIGHT_CTL_CLIENT_SWEEP_ENTRY_LEN;
+    p_sweep->num_results = 0;
 
-    mesh_transport_send_data(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_DEFAULT_STATUS, (uint8_t *)p_hci_event, (uint16_t)(p - (uint8_t *)p_hci_event));
+    mesh_light_ctl_hci_event_send(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SWEEP_RESULT, buffer, (uint16_t)(p - buffer));
 }
 
 #endif
@@ -0,0 +1,265 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/** @file
+ *
+ * Table driven encoding and decoding of the Light CTL messages exchanged with the host.
+ */
+#include <string.h>
+#include "mesh_light_ctl_codec.h"
+
+/******************************************************
+ *          Function Prototypes
+ ******************************************************/
+static uint32_t mesh_light_ctl_codec_member_get(const uint8_t *p_member, uint8_t size);
+static void mesh_light_ctl_codec_member_set(uint8_t *p_member, uint8_t size, uint32_t value);
+
+/******************************************************
+ *          Variables Definitions
+ ******************************************************/
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_get_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(mesh_light_ctl_codec_get_t, max_age, 2),
+};
+
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_set_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_set_t, target.lightness, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_set_t, target.temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_set_t, target.delta_uv, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_set_t, transition_time, 4),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_set_t, delay, 2),
+};
+
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_temperature_set_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_set_t, target_temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_set_t, target_delta_uv, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_set_t, transition_time, 4),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_set_t, delay, 2),
+};
+
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_temperature_range_set_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_range_data_t, min_level, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_range_data_t, max_level, 2),
+};
+
+// Used for the Default Set command and the Default Status event
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_default_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_default_data_t, default_status.lightness, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_default_data_t, default_status.temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_default_data_t, default_status.delta_uv, 2),
+};
+
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_status_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, present.lightness, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, present.temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, target.lightness, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, target.temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, remaining_time, 4),
+};
+
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_temperature_status_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, present.temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, present.delta_uv, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, target.temperature, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, target.delta_uv, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_status_data_t, remaining_time, 4),
+};
+
+static const mesh_light_ctl_codec_field_t mesh_light_ctl_codec_temperature_range_status_fields[] =
+{
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_range_status_data_t, status, 1),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_range_status_data_t, min_level, 2),
+    MESH_LIGHT_CTL_CODEC_FIELD(wiced_bt_mesh_light_ctl_temperature_range_status_data_t, max_level, 2),
+};
+
+#define MESH_LIGHT_CTL_CODEC_MESSAGE(opcode, fields, num_required) \
+    { (opcode), (uint8_t)(sizeof(fields) / sizeof(fields[0])), (num_required), fields }
+
+const mesh_light_ctl_codec_message_t mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_NUM_MESSAGES] =
+{
+    [MESH_LIGHT_CTL_CODEC_GET]                     = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET, mesh_light_ctl_codec_get_fields, 0),
+    [MESH_LIGHT_CTL_CODEC_SET]                     = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET, mesh_light_ctl_codec_set_fields, 5),
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET]         = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET, mesh_light_ctl_codec_get_fields, 0),
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET]         = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET, mesh_light_ctl_codec_temperature_set_fields, 4),
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_GET]   = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET, mesh_light_ctl_codec_get_fields, 0),
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_SET]   = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET, mesh_light_ctl_codec_temperature_range_set_fields, 2),
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_GET]             = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET, mesh_light_ctl_codec_get_fields, 0),
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_SET]             = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET, mesh_light_ctl_codec_default_fields, 3),
+    [MESH_LIGHT_CTL_CODEC_STATUS]                  = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS, mesh_light_ctl_codec_status_fields, 5),
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS]      = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_STATUS, mesh_light_ctl_codec_temperature_status_fields, 5),
+    [MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS] = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_RANGE_STATUS, mesh_light_ctl_codec_temperature_range_status_fields, 3),
+    [MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS]          = MESH_LIGHT_CTL_CODEC_MESSAGE(HCI_CONTROL_MESH_EVENT_LIGHT_CTL_DEFAULT_STATUS, mesh_light_ctl_codec_default_fields, 3),
+};
+
+// Message index plus 1 by the low byte of the opcode, 0 if the opcode is not described.
+// All Light CTL opcodes are in HCI_CONTROL_GROUP_MESH, so the low byte is unique.
+static const uint8_t mesh_light_ctl_codec_command_index[256] =
+{
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_GET & 0xFF]                     = MESH_LIGHT_CTL_CODEC_GET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET & 0xFF]                     = MESH_LIGHT_CTL_CODEC_SET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_GET & 0xFF]         = MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_SET & 0xFF]         = MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_GET & 0xFF]   = MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_GET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TEMPERATURE_RANGE_SET & 0xFF]   = MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_SET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_GET & 0xFF]             = MESH_LIGHT_CTL_CODEC_DEFAULT_GET + 1,
+    [HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_DEFAULT_SET & 0xFF]             = MESH_LIGHT_CTL_CODEC_DEFAULT_SET + 1,
+};
+
+static const uint8_t mesh_light_ctl_codec_event_index[256] =
+{
+    [HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS & 0xFF]                    = MESH_LIGHT_CTL_CODEC_STATUS + 1,
+    [HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_STATUS & 0xFF]        = MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS + 1,
+    [HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TEMPERATURE_RANGE_STATUS & 0xFF]  = MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS + 1,
+    [HCI_CONTROL_MESH_EVENT_LIGHT_CTL_DEFAULT_STATUS & 0xFF]            = MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS + 1,
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+const mesh_light_ctl_codec_message_t *mesh_light_ctl_codec_find_command(uint16_t opcode)
+{
+    uint8_t index = mesh_light_ctl_codec_command_index[opcode & 0xFF];
+
+    if ((index == 0) || (mesh_light_ctl_codec_messages[index - 1].opcode != opcode))
+        return NULL;
+    return &mesh_light_ctl_codec_messages[index - 1];
+}
+
+const mesh_light_ctl_codec_message_t *mesh_light_ctl_codec_find_event(uint16_t opcode)
+{
+    uint8_t index = mesh_light_ctl_codec_event_index[opcode & 0xFF];
+
+    if ((index == 0) || (mesh_light_ctl_codec_messages[index - 1].opcode != opcode))
+        return NULL;
+    return &mesh_light_ctl_codec_messages[index - 1];
+}
+
+uint16_t mesh_light_ctl_codec_length(const mesh_light_ctl_codec_message_t *p_msg, int with_optional)
+{
+    uint16_t length = 0;
+    uint8_t i;
+
+    for (i = 0; i < (with_optional ? p_msg->num_fields : p_msg->num_required); i++)
+        length += p_msg->p_fields[i].wire_size;
+    return length;
+}
+
+uint16_t mesh_light_ctl_codec_decode(const mesh_light_ctl_codec_message_t *p_msg, const uint8_t *p_data, uint32_t length, void *p_struct)
+{
+    const mesh_light_ctl_codec_field_t *p_field;
+    uint32_t value;
+    uint16_t used = 0;
+    uint8_t i, j;
+
+    for (i = 0; i < p_msg->num_fields; i++)
+    {
+        p_field = &p_msg->p_fields[i];
+        if (used + p_field->wire_size > length)
+            return (i < p_msg->num_required) ? MESH_LIGHT_CTL_CODEC_ERROR : used;
+
+        value = 0;
+        for (j = 0; j < p_field->wire_size; j++)
+            value |= (uint32_t)p_data[used++] << (8 * j);
+        mesh_light_ctl_codec_member_set((uint8_t *)p_struct + p_field->offset, p_field->member_size, value);
+    }
+    return used;
+}
+
+uint16_t mesh_light_ctl_codec_encode(const mesh_light_ctl_codec_message_t *p_msg, const void *p_struct, uint8_t *p_buffer, uint32_t size)
+{
+    const mesh_light_ctl_codec_field_t *p_field;
+    uint32_t value;
+    uint16_t used = 0;
+    uint8_t i, j;
+
+    for (i = 0; i < p_msg->num_fields; i++)
+    {
+        p_field = &p_msg->p_fields[i];
+        if (used + p_field->wire_size > size)
+            return MESH_LIGHT_CTL_CODEC_ERROR;
+
+        value = mesh_light_ctl_codec_member_get((const uint8_t *)p_struct + p_field->offset, p_field->member_size);
+        for (j = 0; j < p_field->wire_size; j++)
+            p_buffer[used++] = (uint8_t)(value >> (8 * j));
+    }
+    return used;
+}
+
+/*
+ * Read a structure member of 1, 2 or 4 bytes
+ */
+uint32_t mesh_light_ctl_codec_member_get(const uint8_t *p_member, uint8_t size)
+{
+    uint16_t value16;
+    uint32_t value32;
+
+    switch (size)
+    {
+    case 1:
+        return *p_member;
+    case 2:
+        memcpy(&value16, p_member, sizeof(value16));
+        return value16;
+    default:
+        memcpy(&value32, p_member, sizeof(value32));
+        return value32;
+    }
+}
+
+/*
+ * Write a structure member of 1, 2 or 4 bytes
+ */
+void mesh_light_ctl_codec_member_set(uint8_t *p_member, uint8_t size, uint32_t value)
+{
+    uint16_t value16 = (uint16_t)value;
+
+    switch (size)
+    {
+    case 1:
+        *p_member = (uint8_t)value;
+        break;
+    case 2:
+        memcpy(p_member, &value16, sizeof(value16));
+        break;
+    default:
+        memcpy(p_member, &value, sizeof(value));
+        break;
+    }
+}
@@ -0,0 +1,130 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/** @file
+ *
+ * Light CTL messages exchanged with the host over WICED HCI, described by tables of
+ * field layouts. The tables do not depend on the firmware and can be built into a host
+ * application to encode commands and decode events in the same format.
+ */
+#ifndef MESH_LIGHT_CTL_CODEC_H
+#define MESH_LIGHT_CTL_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "wiced_bt_mesh_models.h"
+#include "hci_control_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Messages described in mesh_light_ctl_codec_messages
+enum
+{
+    MESH_LIGHT_CTL_CODEC_GET,
+    MESH_LIGHT_CTL_CODEC_SET,
+    MESH_LIGHT_CTL_CODEC_TEMPERATURE_GET,
+    MESH_LIGHT_CTL_CODEC_TEMPERATURE_SET,
+    MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_GET,
+    MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_SET,
+    MESH_LIGHT_CTL_CODEC_DEFAULT_GET,
+    MESH_LIGHT_CTL_CODEC_DEFAULT_SET,
+    MESH_LIGHT_CTL_CODEC_NUM_COMMANDS,                  // Commands come first, events follow
+
+    MESH_LIGHT_CTL_CODEC_STATUS = MESH_LIGHT_CTL_CODEC_NUM_COMMANDS,
+    MESH_LIGHT_CTL_CODEC_TEMPERATURE_STATUS,
+    MESH_LIGHT_CTL_CODEC_TEMPERATURE_RANGE_STATUS,
+    MESH_LIGHT_CTL_CODEC_DEFAULT_STATUS,
+    MESH_LIGHT_CTL_CODEC_NUM_MESSAGES
+};
+
+// Field of a message, little endian on the wire
+typedef struct
+{
+    uint8_t offset;                                     // Offset of the member in the decoded structure
+    uint8_t member_size;                                // Size of the member, 1, 2 or 4 bytes
+    uint8_t wire_size;                                  // Size of the field in the message, 1, 2 or 4 bytes
+} mesh_light_ctl_codec_field_t;
+
+#define MESH_LIGHT_CTL_CODEC_FIELD(type, member, wire_size) \
+    { (uint8_t)offsetof(type, member), (uint8_t)sizeof(((type *)0)->member), (wire_size) }
+
+// Layout of a message
+typedef struct
+{
+    uint16_t opcode;                                    // HCI command or event
+    uint8_t  num_fields;
+    uint8_t  num_required;                              // Fields which must be present, the others are optional
+    const mesh_light_ctl_codec_field_t *p_fields;
+} mesh_light_ctl_codec_message_t;
+
+// Decoded Light CTL get commands, the maximum age is 0 if not present
+typedef struct
+{
+    uint16_t max_age;                                   // Maximum age in ms of a status sent from the client cache
+} mesh_light_ctl_codec_get_t;
+
+#define MESH_LIGHT_CTL_CODEC_ERROR      0xFFFF          // Returned if a message cannot be decoded or encoded
+
+extern const mesh_light_ctl_codec_message_t mesh_light_ctl_codec_messages[MESH_LIGHT_CTL_CODEC_NUM_MESSAGES];
+
+/*
+ * Find the layout of an HCI command or event, NULL if it is not described
+ */
+const mesh_light_ctl_codec_message_t *mesh_light_ctl_codec_find_command(uint16_t opcode);
+const mesh_light_ctl_codec_message_t *mesh_light_ctl_codec_find_event(uint16_t opcode);
+
+/*
+ * Length of a message with only the required fields, or with all fields
+ */
+uint16_t mesh_light_ctl_codec_length(const mesh_light_ctl_codec_message_t *p_msg, int with_optional);
+
+/*
+ * Decode a message into the structure at p_struct. Optional fields which are not present are left
+ * unchanged. Returns the number of bytes used, MESH_LIGHT_CTL_CODEC_ERROR if a required field is missing.
+ */
+uint16_t mesh_light_ctl_codec_decode(const mesh_light_ctl_codec_message_t *p_msg, const uint8_t *p_data, uint32_t length, void *p_struct);
+
+/*
+ * Encode all fields of the structure at p_struct. Returns the length of the message,
+ * MESH_LIGHT_CTL_CODEC_ERROR if it does not fit in size bytes.
+ */
+uint16_t mesh_light_ctl_codec_encode(const mesh_light_ctl_codec_message_t *p_msg, const void *p_struct, uint8_t *p_buffer, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MESH_LIGHT_CTL_CODEC_H
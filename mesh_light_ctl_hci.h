@@ -0,0 +1,131 @@
+/*
+* Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/** @file
+ *
+ * Application specific WICED HCI commands and events of the Light CTL Client. Commands which
+ * send mesh messages use the same mesh command header as the Light CTL commands defined in
+ * hci_control_api.h. The opcodes are in HCI_CONTROL_GROUP_MESH, from 0xE0, and are described
+ * in README.md.
+ */
+#ifndef MESH_LIGHT_CTL_HCI_H
+#define MESH_LIGHT_CTL_HCI_H
+
+#include "hci_control_api.h"
+
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI_DST        ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE0 )    /* One Light CTL Set value sent to a list of destinations */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SET_MULTI            ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE1 )    /* List of destination and Light CTL Set value pairs */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_COALESCE_CONFIG      ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE2 )    /* Set minimum interval between sets to the same destination */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STATUS_BATCH_CONFIG  ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE3 )    /* Enable or disable aggregation of status events */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_REQUEST_CONFIG       ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE4 )    /* Configure in-flight window, timeout and retries of tracked requests */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_CONFIG         ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE5 )    /* Set interval of formatting binary trace records at idle */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_READ           ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE6 )    /* Send stored binary trace records to the host */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LATENCY_GET          ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE7 )    /* Send latency histograms to the host */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LATENCY_RESET        ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE8 )    /* Clear latency histograms */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_STAGGER_CONFIG       ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE9 )    /* Configure pacing of group and list sends */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_POOL_STATS_GET       ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEA )    /* Send event and buffer usage statistics to the host */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_SWEEP                ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEB )    /* Get state of a list or range of servers */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_LPN_STATS_GET        ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEC )    /* Send low power node batching counters to the host */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_RANGE_CONFIG         ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xED )    /* Configure checking of set temperatures against the server range */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CURVE_SET            ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEE )    /* Daily lightness and temperature curve for a destination */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_CONFIG        ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEF )    /* Configure change only forwarding of statuses */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_FILTER_STATS_GET     ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xF0 )    /* Send number of statuses not forwarded to the host */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CACHE_DUMP           ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xF1 )    /* Send cached state of all known servers to the host */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CREDIT_CONFIG        ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xF2 )    /* Enable or disable command credits and event sequence numbers */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_CONFIG       ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xF3 )    /* Start or stop recording of HCI commands and events */
+#define HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ         ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xF4 )    /* Send the capture to the host */
+
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_STATUS_BATCH           ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE0 )    /* Several status events in one frame */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE       ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE1 )    /* Tracked request answered or timed out */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_TRACE_DATA             ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE2 )    /* Binary trace records */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LATENCY_HISTOGRAM      ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE3 )    /* Latency histograms of one command and destination class */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS         ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE4 )    /* Command was not accepted */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_POOL_STATS             ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE5 )    /* Event and buffer usage statistics */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SWEEP_RESULT           ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE6 )    /* Packed sweep results */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_LPN_STATS              ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE7 )    /* Low power node batching counters */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_FILTER_STATS           ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE8 )    /* Number of statuses not forwarded */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHE_DUMP             ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xE9 )    /* Cached state of known servers */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CREDIT                 ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEA )    /* Command credits granted to the host */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_SEQUENCED              ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEB )    /* Event with a sequence number */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CAPTURE_DATA           ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xEC )    /* Part of the capture */
+#define HCI_CONTROL_MESH_EVENT_LIGHT_CTL_CACHED_STATUS          ( ( HCI_CONTROL_GROUP_MESH << 8 ) | 0xED )    /* Status answered from the client cache */
+
+// Capture read with HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_CAPTURE_READ is a sequence of records of type (1 byte),
+// ms since the previous record (2 bytes), opcode (2 bytes), length (2 bytes) and, except for events, the data
+#define MESH_LIGHT_CTL_CAPTURE_HDR_LEN          7
+#define MESH_LIGHT_CTL_CAPTURE_COMMAND          0       // HCI command from the host, followed by the command data
+#define MESH_LIGHT_CTL_CAPTURE_EVENT            1       // HCI event to the host, the length is the event length and no data follows
+#define MESH_LIGHT_CTL_CAPTURE_MESH             2       // Mesh event received by the client, followed by the source address
+
+// Trace data read with HCI_CONTROL_MESH_COMMAND_LIGHT_CTL_TRACE_READ holds the number of records dropped (2 bytes)
+// and of records (1 byte), followed by records of tick count (4 bytes), trace id (1 byte) and 5 arguments (4 bytes
+// each). Each trace id is printed with its format, unused arguments are 0.
+#define MESH_LIGHT_CTL_TRACE_DATA_HDR_LEN           3
+#define MESH_LIGHT_CTL_TRACE_DATA_RECORDS           8       // Maximum number of records in one event
+#define MESH_LIGHT_CTL_TRACE_RECORD_LEN             25
+#define MESH_LIGHT_CTL_TRACE_MSG                    0
+#define MESH_LIGHT_CTL_TRACE_MSG_FMT                "pwr lvl clt msg:%d\n"
+#define MESH_LIGHT_CTL_TRACE_TX_COMPLETE            1
+#define MESH_LIGHT_CTL_TRACE_TX_COMPLETE_FMT        "tx complete status:%d\n"
+#define MESH_LIGHT_CTL_TRACE_STATUS                 2
+#define MESH_LIGHT_CTL_TRACE_STATUS_FMT             "light status light/temp present:%d/%d target:%d/%d remain time:%d\n"
+#define MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS         3
+#define MESH_LIGHT_CTL_TRACE_DEFAULT_STATUS_FMT     "default lightness:%d temp:%d uv:%d\n"
+#define MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS     4
+#define MESH_LIGHT_CTL_TRACE_TEMPERATURE_STATUS_FMT "temp status: temp/UV present %d/%d target:%d/%d time:%d\n"
+#define MESH_LIGHT_CTL_TRACE_RANGE_STATUS           5
+#define MESH_LIGHT_CTL_TRACE_RANGE_STATUS_FMT       "temp range status: status %d min/max:%d/%d\n"
+#define MESH_LIGHT_CTL_TRACE_CACHE_REPLY            6
+#define MESH_LIGHT_CTL_TRACE_CACHE_REPLY_FMT        "ctl cache reply dst:%04x kind:%d age:%d\n"
+#define MESH_LIGHT_CTL_TRACE_REQUEST_FAILED         7
+#define MESH_LIGHT_CTL_TRACE_REQUEST_FAILED_FMT     "ctl request failed id:%d dst:%04x\n"
+#define MESH_LIGHT_CTL_TRACE_NUM_IDS                8
+
+#define MESH_LIGHT_CTL_CLIENT_ELEMENT_ANY       0xFF    // Element index in a command header which lets the client choose the element
+
+// Status reported in HCI_CONTROL_MESH_EVENT_LIGHT_CTL_COMMAND_STATUS
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_NO_BUDGET     1   // Client holds the maximum number of events
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_NO_EVENT      2   // Mesh event could not be created
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_BUSY          3   // Previous command of this kind is not finished
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_OUT_OF_RANGE  4   // Temperature is outside of the server range, nothing sent
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_CLAMPED       5   // Temperature was outside of the server range and has been clamped
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_NO_RESOURCES  6   // No room to store the command
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_LENGTH    7   // Command is shorter than its required fields
+#define MESH_LIGHT_CTL_CLIENT_COMMAND_BAD_VALUE     8   // Configuration value is not valid, nothing changed
+
+// Result reported in HCI_CONTROL_MESH_EVENT_LIGHT_CTL_REQUEST_COMPLETE
+#define MESH_LIGHT_CTL_CLIENT_RESULT_SUCCESS        0
+#define MESH_LIGHT_CTL_CLIENT_RESULT_TIMEOUT        1
+#define MESH_LIGHT_CTL_CLIENT_RESULT_NO_RESOURCES   2
+
+#endif // MESH_LIGHT_CTL_HCI_H